@@ -0,0 +1,429 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Chris McArthur, prince.chrismc(at)gmail(dot)com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "BatchDownloader.h"
+#include "ConnectionPool.h"
+#include "ContentCoding.h"
+#include "HttpResponseStream.h"
+#include "Url.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <deque>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <unordered_map>
+
+#ifdef _WIN32
+#include <winsock2.h>
+static int poll( pollfd* fds, size_t count, int timeout ) { return WSAPoll( fds, static_cast<ULONG>( count ), timeout ); }
+static bool wouldBlock() { return WSAGetLastError() == WSAEWOULDBLOCK; }
+static constexpr int SEND_FLAGS = 0;
+#else
+#include <sys/socket.h>
+#include <cerrno>
+static bool wouldBlock() { return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR; }
+#ifdef MSG_NOSIGNAL
+static constexpr int SEND_FLAGS = MSG_NOSIGNAL; // a server hanging up must not kill the process
+#else
+static constexpr int SEND_FLAGS = 0;
+#endif
+#endif
+
+using namespace std::chrono_literals;
+
+namespace
+{
+   // One connection and the URL it is working on
+   struct Transfer
+   {
+      std::unique_ptr<CActiveSocket> m_pSocket;
+      std::unique_ptr<Connector::Attempt> m_pConnecting; // until the socket is connected
+      std::string m_sKey;
+      bool m_bReused = false;
+
+      bool m_bActive = false;
+      size_t m_ulIndex = 0;
+      std::string m_sRequest;
+      size_t m_ulSent = 0;
+      std::string m_sPath;
+      FILE* m_pFile = nullptr;
+      std::optional<HttpResponseStream> m_oStream;
+      std::unique_ptr<Http::ContentCoding::Decoder> m_pDecoder; // only for a compressed body
+      std::chrono::steady_clock::time_point m_tProgress;
+   };
+}
+
+static void closeSocket( Transfer& transfer )
+{
+   transfer.m_pConnecting.reset();
+   if( transfer.m_pSocket == nullptr ) return;
+
+   transfer.m_pSocket->Close();
+   transfer.m_pSocket.reset();
+}
+
+// Ends the work on the current URL, the connection stays open when it can take the next one
+static void finish( Transfer& transfer, bool succeeded, bool keepConnection )
+{
+   if( transfer.m_pFile != nullptr )
+   {
+      succeeded = std::fclose( transfer.m_pFile ) == 0 && succeeded;
+      transfer.m_pFile = nullptr;
+
+      std::error_code oError;
+      if( !succeeded ) std::filesystem::remove( transfer.m_sPath, oError ); // never leave a partial file behind
+   }
+
+   if( !keepConnection ) closeSocket( transfer );
+
+   transfer.m_oStream.reset();
+   transfer.m_pDecoder.reset();
+   transfer.m_bActive = false;
+}
+
+// Directories created for a file that was then removed go with it, up to the output directory
+static void removeEmptyParents( const std::string& path, const std::string& directory )
+{
+   std::error_code oError;
+   const std::filesystem::path oRoot = std::filesystem::weakly_canonical( directory, oError );
+   for( std::filesystem::path oParent = std::filesystem::path( path ).parent_path();
+        !oParent.empty() && std::filesystem::weakly_canonical( oParent, oError ) != oRoot && std::filesystem::is_empty( oParent, oError );
+        oParent = oParent.parent_path() )
+   {
+      if( !std::filesystem::remove( oParent, oError ) ) break;
+   }
+}
+
+static std::string buildRequest( const Href& href, const std::vector<std::pair<std::string, std::string>>& headers )
+{
+   HttpRequest oReq( Http::RequestMethod::Get, href.m_sUri, Http::Version::v11, ConnectionPool::KeyOf( href ) );
+   if( !Http::ContentCoding::AcceptEncoding().empty() ) oReq.SetMessageHeader( "Accept-Encoding", Http::ContentCoding::AcceptEncoding() );
+   for( const auto& [ sKey, sValue ] : headers ) oReq.SetMessageHeader( sKey, sValue );
+
+   return oReq.GetWireFormat();
+}
+
+BatchDownloader::BatchDownloader( const Options& options, const Connector& connector ) : m_oOptions( options ), m_oConnector( connector )
+{
+   if( m_oOptions.m_uConnections == 0 ) throw std::invalid_argument( "At least one connection is required!" );
+}
+
+BatchDownloader::Summary BatchDownloader::Run( const std::vector<Href>& hrefs ) const
+{
+   const auto tStart = std::chrono::steady_clock::now();
+   Summary oSummary;
+
+   // Two URLs saved to the same file would write over each other, only the first of them is fetched
+   std::vector<std::string> vecPaths;
+   std::unordered_map<std::string, size_t> mapFirstWithPath;
+   std::deque<size_t> quePending;
+   for( size_t ulIndex = 0; ulIndex < hrefs.size(); ulIndex += 1 )
+   {
+      vecPaths.push_back( OutputPathOf( m_oOptions.m_sDirectory, hrefs[ ulIndex ] ) );
+      const auto [ itor, bFirst ] = mapFirstWithPath.emplace( vecPaths.back(), ulIndex );
+      if( bFirst )
+      {
+         quePending.push_back( ulIndex );
+         continue;
+      }
+
+      const Href& oFirst = hrefs[ itor->second ];
+      std::cout << "Failed " << hrefs[ ulIndex ].m_sHostName << hrefs[ ulIndex ].m_sUri << ": saved to the same file as "
+                << oFirst.m_sHostName << oFirst.m_sUri << std::endl;
+      oSummary.m_nFailed += 1;
+   }
+
+   std::vector<Transfer> vecTransfers( std::min<size_t>( m_oOptions.m_uConnections, hrefs.size() ) );
+   std::vector<pollfd> vecPoll;
+   std::vector<std::pair<Transfer*, size_t>> vecPolled; // with the first of its entries, a connect may have several
+   std::vector<char> vecBuffer( 64 * 1024 );
+
+   const auto fail = [ & ]( Transfer& transfer, const std::string& reason )
+   {
+      std::cout << "Failed " << hrefs[ transfer.m_ulIndex ].m_sHostName << hrefs[ transfer.m_ulIndex ].m_sUri << ": " << reason << std::endl;
+      oSummary.m_nFailed += 1;
+      finish( transfer, false, false );
+      removeEmptyParents( transfer.m_sPath, m_oOptions.m_sDirectory );
+   };
+
+   // A connection kept from an earlier URL may have been closed by the server while idle, its URL goes back in line
+   const auto retryOrFail = [ & ]( Transfer& transfer, const std::string& reason )
+   {
+      if( transfer.m_bReused && !transfer.m_oStream->HasHeaders() && transfer.m_oStream->GetBodyLength() == 0 )
+      {
+         quePending.push_front( transfer.m_ulIndex );
+         finish( transfer, false, false );
+      }
+      else
+      {
+         fail( transfer, reason );
+      }
+   };
+
+   const auto start = [ & ]( Transfer& transfer, size_t index )
+   {
+      const Href& oHref = hrefs[ index ];
+      transfer.m_ulIndex = index;
+      transfer.m_bActive = true;
+      transfer.m_tProgress = std::chrono::steady_clock::now();
+      transfer.m_sPath = vecPaths[ index ];
+
+      const std::string sKey = ConnectionPool::KeyOf( oHref );
+      transfer.m_bReused = transfer.m_pSocket != nullptr && transfer.m_sKey == sKey;
+      if( !transfer.m_bReused )
+      {
+         closeSocket( transfer );
+         transfer.m_sKey = sKey;
+         oSummary.m_nConnects += 1;
+
+         try
+         {
+            transfer.m_pConnecting = std::make_unique<Connector::Attempt>( m_oConnector, oHref.m_sHostName, oHref.m_nPortNumber );
+         }
+         catch( const Connector::ConnectError& e )
+         {
+            return fail( transfer, e.what() );
+         }
+      }
+
+      std::error_code oError;
+      std::filesystem::create_directories( std::filesystem::path( transfer.m_sPath ).parent_path(), oError );
+
+      transfer.m_pFile = std::fopen( transfer.m_sPath.c_str(), "wb" );
+      if( transfer.m_pFile == nullptr ) return fail( transfer, "unable to write " + transfer.m_sPath );
+
+      transfer.m_sRequest = buildRequest( oHref, m_oOptions.m_vecExtraHeaders );
+      transfer.m_ulSent = 0;
+      // A compressed body is decoded on its way to the file, which coding it has is only known once the headers are in
+      const auto writeFile = [ pFile = transfer.m_pFile ]( std::string_view data ) { std::fwrite( data.data(), 1, data.size(), pFile ); };
+      transfer.m_oStream.emplace( [ &transfer, writeFile ]( std::string_view data )
+                                  {
+                                     if( transfer.m_pDecoder != nullptr ) transfer.m_pDecoder->Feed( data );
+                                     else writeFile( data );
+                                  },
+                                  [ &transfer, writeFile ]( const HttpResponseStream& stream )
+                                  {
+                                     const auto oCoding = Http::ContentCoding::Parse( stream.GetHeaders().GetMessageHeader( "Content-Encoding" ) );
+                                     if( Http::ContentCoding::IS_AVAILABLE && oCoding.value_or( Http::ContentCoding::Coding::Identity ) != Http::ContentCoding::Coding::Identity )
+                                        transfer.m_pDecoder = std::make_unique<Http::ContentCoding::Decoder>( *oCoding, writeFile );
+                                  } );
+   };
+
+   // The request goes out once one of the host's addresses answers
+   const auto connect = [ & ]( Transfer& transfer, const pollfd* polled )
+   {
+      try
+      {
+         transfer.m_pSocket = transfer.m_pConnecting->Step( polled );
+      }
+      catch( const Connector::ConnectError& e )
+      {
+         return fail( transfer, e.what() );
+      }
+
+      if( transfer.m_pSocket == nullptr ) return;
+
+      transfer.m_pConnecting.reset();
+      transfer.m_tProgress = std::chrono::steady_clock::now();
+      if( !transfer.m_pSocket->SetNonblocking() ) fail( transfer, "unable to make the connection non-blocking" );
+   };
+
+   const auto complete = [ & ]( Transfer& transfer, bool keepConnection )
+   {
+      const HttpResponse& oHeaders = transfer.m_oStream->GetHeaders();
+      if( oHeaders.GetStatusCode() < Http::Status::Ok || oHeaders.GetStatusCode() >= Http::Status::MultipleChoices )
+      {
+         fail( transfer, "status " + std::to_string( static_cast<int>( oHeaders.GetStatusCode() ) ) + " " + std::string( oHeaders.GetPhrase() ) );
+         return;
+      }
+
+      if( transfer.m_pDecoder != nullptr && !transfer.m_pDecoder->IsComplete() )
+      {
+         fail( transfer, "compressed body was cut short" );
+         return;
+      }
+
+      if( m_oOptions.m_bVerbose )
+         std::cout << "Saved " << transfer.m_sPath << " (" << transfer.m_oStream->GetBodyLength() << " bytes)" << std::endl;
+
+      oSummary.m_nSucceeded += 1;
+      oSummary.m_ulBytes += transfer.m_oStream->GetBodyLength();
+      finish( transfer, true, keepConnection );
+   };
+
+   const auto receive = [ & ]( Transfer& transfer )
+   {
+      const auto nReceived = ::recv( transfer.m_pSocket->GetSocketDescriptor(), vecBuffer.data(), static_cast<int>( vecBuffer.size() ), 0 );
+      if( nReceived < 0 )
+      {
+         if( !wouldBlock() ) retryOrFail( transfer, "connection lost" );
+         return;
+      }
+
+      // A response that makes no sense, down to a malformed status, fails its URL and nothing else
+      const std::string_view data( vecBuffer.data(), static_cast<size_t>( nReceived ) );
+      size_t ulUsed = 0;
+      bool bClosed = false;
+      try
+      {
+         if( nReceived == 0 )
+            bClosed = transfer.m_oStream->Close();
+         else
+            ulUsed = transfer.m_oStream->Feed( data );
+      }
+      catch( const std::runtime_error& e )
+      {
+         fail( transfer, e.what() );
+         return;
+      }
+      catch( const std::exception& )
+      {
+         fail( transfer, "malformed response" );
+         return;
+      }
+
+      if( nReceived == 0 )
+      {
+         if( bClosed )
+            complete( transfer, false );
+         else
+            retryOrFail( transfer, "connection closed before the response was complete" );
+         return;
+      }
+
+      transfer.m_tProgress = std::chrono::steady_clock::now();
+
+      // Bytes past the end of the response are not ours to make sense of, the connection is not reused
+      if( transfer.m_oStream->IsComplete() )
+         complete( transfer, ulUsed == data.size() && transfer.m_oStream->IsPersistent() );
+   };
+
+   const auto send = [ & ]( Transfer& transfer )
+   {
+      const auto nSent = ::send( transfer.m_pSocket->GetSocketDescriptor(), transfer.m_sRequest.data() + transfer.m_ulSent,
+                                 static_cast<int>( transfer.m_sRequest.size() - transfer.m_ulSent ), SEND_FLAGS );
+      if( nSent < 0 )
+      {
+         if( !wouldBlock() ) retryOrFail( transfer, "unable to send the request" );
+         return;
+      }
+
+      transfer.m_ulSent += static_cast<size_t>( nSent );
+      transfer.m_tProgress = std::chrono::steady_clock::now();
+   };
+
+   while( true )
+   {
+      for( auto& oTransfer : vecTransfers )
+         while( !oTransfer.m_bActive && !quePending.empty() )
+         {
+            const size_t ulIndex = quePending.front();
+            quePending.pop_front();
+            start( oTransfer, ulIndex );
+         }
+
+      vecPoll.clear();
+      vecPolled.clear();
+      auto tWakeUp = std::chrono::steady_clock::now() + 100ms;
+      for( auto& oTransfer : vecTransfers )
+      {
+         if( !oTransfer.m_bActive ) continue;
+
+         vecPolled.emplace_back( &oTransfer, vecPoll.size() );
+         if( oTransfer.m_pConnecting != nullptr )
+         {
+            tWakeUp = std::min( tWakeUp, oTransfer.m_pConnecting->Watch( vecPoll ) );
+            continue;
+         }
+
+         const short nEvents = oTransfer.m_ulSent < oTransfer.m_sRequest.size() ? POLLOUT : POLLIN;
+         vecPoll.push_back( pollfd{ oTransfer.m_pSocket->GetSocketDescriptor(), nEvents, 0 } );
+      }
+
+      if( vecPoll.empty() ) break; // nothing in flight and nothing left to start
+
+      const auto lWait = std::chrono::duration_cast<std::chrono::milliseconds>( tWakeUp - std::chrono::steady_clock::now() ).count() + 1;
+      if( poll( vecPoll.data(), vecPoll.size(), static_cast<int>( std::max<long long>( lWait, 0 ) ) ) < 0 && !wouldBlock() )
+         throw std::runtime_error( "Unable to wait on the connections" );
+
+      const auto tNow = std::chrono::steady_clock::now();
+      for( const auto& [ pTransfer, ulSlot ] : vecPolled )
+      {
+         Transfer& oTransfer = *pTransfer;
+         if( oTransfer.m_pConnecting != nullptr )
+         {
+            connect( oTransfer, &vecPoll[ ulSlot ] ); // gives up on its own once the connect timeout is reached
+            continue;
+         }
+
+         const short nReady = vecPoll[ ulSlot ].revents;
+
+         if( nReady & POLLOUT )
+            send( oTransfer );
+         else if( nReady & ( POLLIN | POLLHUP | POLLERR ) )
+            receive( oTransfer );
+         else if( tNow - oTransfer.m_tProgress > m_oOptions.m_Timeout )
+            fail( oTransfer, "timed out" );
+      }
+   }
+
+   for( auto& oTransfer : vecTransfers ) closeSocket( oTransfer );
+
+   oSummary.m_Elapsed = std::chrono::steady_clock::now() - tStart;
+   return oSummary;
+}
+
+std::string BatchDownloader::OutputPathOf( const std::string& directory, const Href& href )
+{
+   const std::optional<Http::Url> oTarget = Http::Url::ParseRequestTarget( href.m_sUri );
+
+   std::string sUriPath;
+   if( oTarget.has_value() && !Http::PercentDecode( oTarget->m_sPath, sUriPath ) ) sUriPath.assign( oTarget->m_sPath ); // saved as written
+
+   // One directory per host, named so that any file system takes it
+   std::string sHost = href.m_sHostName + ( href.m_nPortNumber != 80 ? "_" + std::to_string( href.m_nPortNumber ) : "" );
+   for( char& cLetter : sHost )
+      if( !std::isalnum( static_cast<unsigned char>( cLetter ) ) && cLetter != '.' && cLetter != '-' ) cLetter = '_';
+   if( sHost == "." || sHost == ".." ) sHost = "_";
+
+   const std::filesystem::path oHostDirectory = std::filesystem::path( directory ) / sHost;
+   std::filesystem::path oPath = oHostDirectory;
+   for( const auto& oSegment : std::filesystem::path( sUriPath ).relative_path() )
+   {
+      // A segment such as "c:" is a root name on Windows, appending it would replace everything before
+      if( oSegment.empty() || oSegment == "." || oSegment == ".." || oSegment.has_root_name() || oSegment.has_root_directory() ) continue;
+      oPath /= oSegment;
+   }
+
+   if( oPath == oHostDirectory || sUriPath.empty() || sUriPath.back() == '/' )
+      oPath /= "index.html";
+
+   return oPath.string();
+}
@@ -0,0 +1,74 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Chris McArthur, prince.chrismc(at)gmail(dot)com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#pragma once
+
+#include "Href.h"
+#include "Connector.h"
+#include <chrono>
+#include <string>
+#include <utility>
+#include <vector>
+
+//
+// Fetches many URLs at once from a single thread. A bounded set of non-blocking connections is driven by one poll
+// loop, each response body is written to its file as it arrives. Connections kept alive by the server are reused for
+// the next URL on the same host.
+//
+class BatchDownloader
+{
+public:
+   struct Options
+   {
+      unsigned m_uConnections = 8;
+      std::string m_sDirectory = "."; // files are laid out under it in a directory per host, following the path of their URL
+      std::vector<std::pair<std::string, std::string>> m_vecExtraHeaders;
+      bool m_bVerbose = false;
+      std::chrono::seconds m_Timeout{ 30 }; // a connection making no progress for this long fails its URL
+   };
+
+   struct Summary
+   {
+      size_t m_nSucceeded = 0;
+      size_t m_nFailed = 0;
+      size_t m_nConnects = 0;
+      uint64_t m_ulBytes = 0; // of the bodies written
+      std::chrono::duration<double> m_Elapsed{ 0 };
+   };
+
+   BatchDownloader( const Options& options, const Connector& connector );
+
+   Summary Run( const std::vector<Href>& hrefs ) const;
+
+   // Never outside the directory, ".." segments and those naming a root are dropped and a path ending with '/' is saved
+   // as index.html. URLs given more than once, or that only differ in what is dropped, share a path and only the first
+   // is fetched.
+   static std::string OutputPathOf( const std::string& directory, const Href& href );
+
+private:
+   Options m_oOptions;
+   const Connector& m_oConnector;
+};
@@ -0,0 +1,80 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Chris McArthur, prince.chrismc(at)gmail(dot)com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "ConnectionPool.h"
+
+ConnectionPool::ConnectionPool( const Connector& connector ) : m_oConnector( connector )
+{
+}
+
+ConnectionPool::~ConnectionPool()
+{
+   for( auto& [ sKey, vecSockets ] : m_Idle )
+      for( auto& pSocket : vecSockets ) pSocket->Close();
+}
+
+ConnectionPool::Connection ConnectionPool::Acquire( const Href& href )
+{
+   Connection oConnection{ KeyOf( href ), nullptr, false };
+
+   auto itor = m_Idle.find( oConnection.m_sKey );
+   if( itor != m_Idle.end() && !itor->second.empty() )
+   {
+      oConnection.m_pSocket = std::move( itor->second.back() ); // most recently used, least likely to have timed out
+      oConnection.m_bReused = true;
+      itor->second.pop_back();
+      return oConnection;
+   }
+
+   oConnection.m_pSocket = m_oConnector.Connect( href.m_sHostName, href.m_nPortNumber );
+   return oConnection;
+}
+
+void ConnectionPool::Release( Connection&& connection )
+{
+   auto& vecSockets = m_Idle[ connection.m_sKey ];
+   if( vecSockets.size() >= MAX_IDLE_PER_HOST )
+   {
+      Close( connection );
+      return;
+   }
+
+   vecSockets.push_back( std::move( connection.m_pSocket ) );
+}
+
+void ConnectionPool::Close( Connection& connection )
+{
+   if( connection.m_pSocket == nullptr ) return;
+
+   connection.m_pSocket->Close();
+   connection.m_pSocket.reset();
+}
+
+std::string ConnectionPool::KeyOf( const Href& href )
+{
+   const bool bIpv6 = href.m_sHostName.find( ':' ) != std::string::npos; // keeps its brackets in a Host header
+   return ( bIpv6 ? "[" + href.m_sHostName + "]" : href.m_sHostName ) + ":" + std::to_string( href.m_nPortNumber );
+}
@@ -0,0 +1,74 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Chris McArthur, prince.chrismc(at)gmail(dot)com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#pragma once
+
+#include "Href.h"
+#include "ActiveSocket.h"
+#include "Connector.h"
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+//
+// Connections left open by HTTP/1.1 servers, kept by host and port so the next request to the same place skips
+// connecting again.
+//
+class ConnectionPool
+{
+public:
+   struct Connection
+   {
+      std::string m_sKey;
+      std::unique_ptr<CActiveSocket> m_pSocket;
+      bool m_bReused = false; // came out of the pool, the server may have closed it while it waited
+   };
+
+   explicit ConnectionPool( const Connector& connector );
+   ~ConnectionPool();
+
+   ConnectionPool( const ConnectionPool& ) = delete;
+   ConnectionPool& operator=( const ConnectionPool& ) = delete;
+
+   // An idle connection to the same host and port when there is one, a new connection otherwise. Throws ConnectionError.
+   Connection Acquire( const Href& href );
+
+   // Only for connections the server intends to keep open, the others must be closed instead
+   void Release( Connection&& connection );
+
+   static void Close( Connection& connection );
+
+   static std::string KeyOf( const Href& href );
+
+   static constexpr size_t MAX_IDLE_PER_HOST = 4;
+
+   using ConnectionError = Connector::ConnectError;
+
+private:
+   const Connector& m_oConnector;
+   std::map<std::string, std::vector<std::unique_ptr<CActiveSocket>>> m_Idle;
+};
@@ -0,0 +1,182 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Chris McArthur, prince.chrismc(at)gmail(dot)com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "Connector.h"
+#include <algorithm>
+#include <vector>
+
+#ifdef _WIN32
+static int poll( pollfd* fds, size_t count, int timeout ) { return WSAPoll( fds, static_cast<ULONG>( count ), timeout ); }
+static bool isPending() { return WSAGetLastError() == WSAEWOULDBLOCK; }
+static void closeDescriptor( SOCKET socket ) { closesocket( socket ); }
+static bool setNonblocking( SOCKET socket ) { u_long ulMode = 1; return ioctlsocket( socket, FIONBIO, &ulMode ) == 0; }
+static const SOCKET SOCKET_ERROR_VALUE = INVALID_SOCKET; // SOCKET is unsigned here, nothing is below zero
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+static bool isPending() { return errno == EINPROGRESS; }
+static void closeDescriptor( SOCKET socket ) { ::close( socket ); }
+static bool setNonblocking( SOCKET socket ) { return fcntl( socket, F_SETFL, fcntl( socket, F_GETFL ) | O_NONBLOCK ) == 0; }
+static const SOCKET SOCKET_ERROR_VALUE = -1;
+#endif
+
+namespace
+{
+   // Takes over a descriptor connected here, the way CPassiveSocket hands out the ones it accepts
+   class ConnectedSocket : public CActiveSocket
+   {
+   public:
+      explicit ConnectedSocket( SOCKET socket )
+      {
+         Close(); // whatever descriptor it started with
+         SetSocketHandle( socket );
+         SetBlocking();
+      }
+   };
+}
+
+// The connect has started, SOCKET_ERROR_VALUE when it failed at once
+static SOCKET startConnect( const Resolver::Address& address )
+{
+   const SOCKET oSocket = ::socket( address.GetFamily(), SOCK_STREAM, IPPROTO_TCP );
+   if( oSocket == SOCKET_ERROR_VALUE ) return SOCKET_ERROR_VALUE;
+
+   if( !setNonblocking( oSocket ) ||
+       ( ::connect( oSocket, reinterpret_cast<const sockaddr*>( &address.m_Storage ), address.m_nLength ) != 0 && !isPending() ) )
+   {
+      closeDescriptor( oSocket );
+      return SOCKET_ERROR_VALUE;
+   }
+
+   return oSocket;
+}
+
+static bool connectSucceeded( SOCKET socket )
+{
+   int iError = 0;
+   socklen_t nLength = sizeof( iError );
+   return getsockopt( socket, SOL_SOCKET, SO_ERROR, reinterpret_cast<char*>( &iError ), &nLength ) == 0 && iError == 0;
+}
+
+Connector::Attempt::Attempt( const Connector& connector, const std::string& host, uint16_t port )
+   : m_sHost( host )
+   , m_nPort( port )
+   , m_Timeout( connector.m_Timeout )
+   , m_vecAddresses( connector.m_oResolver.Resolve( host, port ) )
+   , m_tDeadline( std::chrono::steady_clock::now() + m_Timeout )
+{
+   if( m_vecAddresses.empty() ) throw ConnectError( "Unable to resolve " + host );
+
+   startDue( std::chrono::steady_clock::now() );
+   if( m_vecConnecting.empty() ) throw ConnectError( "Connection to " + host + ":" + std::to_string( port ) + " could not be established!" );
+}
+
+Connector::Attempt::~Attempt()
+{
+   for( SOCKET oSocket : m_vecConnecting ) closeDescriptor( oSocket );
+}
+
+std::chrono::steady_clock::time_point Connector::Attempt::Watch( std::vector<pollfd>& polls ) const
+{
+   for( SOCKET oSocket : m_vecConnecting ) polls.push_back( pollfd{ oSocket, POLLOUT, 0 } );
+
+   return ( m_ulNextAddress < m_vecAddresses.size() ) ? std::min( m_tDeadline, m_tNextAttempt ) : m_tDeadline;
+}
+
+std::unique_ptr<CActiveSocket> Connector::Attempt::Step( const pollfd* polled )
+{
+   const auto tNow = std::chrono::steady_clock::now();
+
+   SOCKET oWinner = SOCKET_ERROR_VALUE;
+   std::vector<SOCKET> vecStillConnecting;
+   for( size_t ulSlot = 0; ulSlot < m_vecConnecting.size(); ulSlot += 1 )
+   {
+      const SOCKET oSocket = m_vecConnecting[ ulSlot ];
+      if( polled[ ulSlot ].revents == 0 )
+      {
+         vecStillConnecting.push_back( oSocket );
+      }
+      else if( oWinner == SOCKET_ERROR_VALUE && connectSucceeded( oSocket ) )
+      {
+         oWinner = oSocket;
+      }
+      else
+      {
+         closeDescriptor( oSocket );
+         m_tNextAttempt = tNow; // a refusal moves straight on to the next address
+      }
+   }
+   m_vecConnecting.swap( vecStillConnecting );
+
+   if( oWinner != SOCKET_ERROR_VALUE ) return std::make_unique<ConnectedSocket>( oWinner );
+
+   if( tNow >= m_tDeadline )
+      throw ConnectError( "Connection to " + m_sHost + ":" + std::to_string( m_nPort ) + " could not be established within " +
+                          std::to_string( m_Timeout.count() ) + " ms!" );
+
+   startDue( tNow );
+   if( m_vecConnecting.empty() ) // every address refused
+      throw ConnectError( "Connection to " + m_sHost + ":" + std::to_string( m_nPort ) + " could not be established!" );
+
+   return nullptr;
+}
+
+// Start the next attempt once the last one failed or has kept us waiting long enough
+void Connector::Attempt::startDue( std::chrono::steady_clock::time_point now )
+{
+   while( m_ulNextAddress < m_vecAddresses.size() && ( now >= m_tNextAttempt || m_vecConnecting.empty() ) )
+   {
+      const SOCKET oSocket = startConnect( m_vecAddresses[ m_ulNextAddress++ ] );
+      if( oSocket == SOCKET_ERROR_VALUE ) continue; // failed at once, on to the next
+
+      m_vecConnecting.push_back( oSocket );
+      m_tNextAttempt = now + ATTEMPT_DELAY;
+   }
+}
+
+Connector::Connector( Resolver& resolver, std::chrono::milliseconds timeout ) : m_oResolver( resolver ), m_Timeout( timeout )
+{
+}
+
+std::unique_ptr<CActiveSocket> Connector::Connect( const std::string& host, uint16_t port ) const
+{
+   Attempt oAttempt( *this, host, port );
+
+   std::vector<pollfd> vecPoll;
+   std::unique_ptr<CActiveSocket> pSocket;
+   while( pSocket == nullptr )
+   {
+      vecPoll.clear();
+      const auto tWakeUp = oAttempt.Watch( vecPoll );
+      const auto lWait = std::chrono::duration_cast<std::chrono::milliseconds>( tWakeUp - std::chrono::steady_clock::now() ).count() + 1;
+      poll( vecPoll.data(), vecPoll.size(), static_cast<int>( std::max<long long>( lWait, 0 ) ) );
+
+      pSocket = oAttempt.Step( vecPoll.data() );
+   }
+
+   return pSocket;
+}
@@ -0,0 +1,98 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Chris McArthur, prince.chrismc(at)gmail(dot)com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#pragma once
+
+#include "ActiveSocket.h"
+#include "Resolver.h"
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+using pollfd = WSAPOLLFD; // Resolver.h brings in winsock2.h
+#else
+#include <poll.h>
+#endif
+
+//
+// Opens connections with non-blocking connects, racing the addresses of a host happy eyeballs style ( RFC 8305 ). The
+// next address is tried when the previous one failed or has not answered within the attempt delay, the first to
+// connect wins and the others are dropped. Nothing takes longer than the timeout, however many addresses there are.
+//
+class Connector
+{
+public:
+   using ConnectError = std::runtime_error;
+
+   //
+   // One host being connected to, stepped by whoever polls its sockets so that many can be waited on at once
+   //
+   class Attempt
+   {
+   public:
+      // Resolves the host and starts on its first address, throws ConnectError when none can be tried
+      Attempt( const Connector& connector, const std::string& host, uint16_t port );
+      ~Attempt(); // drops whatever is still connecting
+
+      Attempt( const Attempt& ) = delete;
+      Attempt& operator=( const Attempt& ) = delete;
+
+      // Adds a POLLOUT entry for each socket still connecting, returns when the attempt must be stepped at the latest
+      std::chrono::steady_clock::time_point Watch( std::vector<pollfd>& polls ) const;
+
+      // Takes what poll said about the entries Watch added, in the same order, and starts the next address when due.
+      // Returns the connection once made, in blocking mode, throws ConnectError when no address could be reached in time.
+      std::unique_ptr<CActiveSocket> Step( const pollfd* polled );
+
+   private:
+      std::string m_sHost;
+      uint16_t m_nPort;
+      std::chrono::milliseconds m_Timeout;
+      std::vector<Resolver::Address> m_vecAddresses;
+      size_t m_ulNextAddress = 0;
+      std::vector<SOCKET> m_vecConnecting;
+      std::chrono::steady_clock::time_point m_tDeadline;
+      std::chrono::steady_clock::time_point m_tNextAttempt;
+
+      void startDue( std::chrono::steady_clock::time_point now );
+   };
+
+   Connector( Resolver& resolver, std::chrono::milliseconds timeout );
+
+   // Connected and back in blocking mode, throws ConnectError when no address could be reached in time
+   std::unique_ptr<CActiveSocket> Connect( const std::string& host, uint16_t port ) const;
+
+   std::chrono::milliseconds GetTimeout() const { return m_Timeout; }
+
+   static constexpr std::chrono::milliseconds ATTEMPT_DELAY{ 250 };
+
+private:
+   Resolver& m_oResolver;
+   const std::chrono::milliseconds m_Timeout;
+};
@@ -25,16 +25,25 @@ SOFTWARE.
 */
 
 #include "CurlAppController.h"
+#include "BatchDownloader.h"
+#include "ContentCoding.h"
 #include <iostream>
 #include <fstream>
+#include <memory>
 #include <sstream>
 #include <stdexcept>
+#include <vector>
 #include "ActiveSocket.h"
 
 CurlAppController::CurlAppController( int argc, char ** argv )
    : m_oCliParser( argc, argv )
    , m_eCommand( Http::RequestMethod::Invalid )
    , m_bVerbose( false )
+   , m_bPipeline( false )
+   , m_bFetch( false )
+   , m_uConnections( 8 )
+   , m_sOutputDirectory( "." )
+   , m_ConnectTimeout( 5000 )
 {
    readCommandLineArgs();
 }
@@ -47,8 +56,11 @@ void CurlAppController::readCommandLineArgs()
    if( *itor == "help" ) printUsageGivenArgs();
    else if( *itor == "get" ) m_eCommand = Http::RequestMethod::Get;
    else if( *itor == "post" ) m_eCommand = Http::RequestMethod::Post;
+   else if( *itor == "fetch" ) { m_eCommand = Http::RequestMethod::Get; m_bFetch = true; }
    else { printUsageGivenArgs(); throw std::invalid_argument( MISSING_GET_OR_POST.data() ); }
 
+   if( m_bFetch ) { parseFetchOptions( ++itor ); return; }
+
    switch( m_eCommand )
    {
    case Http::RequestMethod::Get:
@@ -75,63 +87,191 @@ void CurlAppController::Run()
       throw std::runtime_error( "If you see this please don't look for the developer to report a bug =)" );
    }
 
+   // One lookup per host for the whole run, however many connections go to it
+   Resolver oResolver;
+   const Connector oConnector( oResolver, m_ConnectTimeout );
+
+   if( m_bFetch ) return download( oConnector );
+
+   // Bodies are written as they arrive, to the file given or after their headers on the console
+   std::ofstream oOutputFile;
+   if( !m_sOutputFile.empty() )
+   {
+      oOutputFile.open( m_sOutputFile, std::ios::out | std::ios::binary | std::ios::trunc );
+      if( !oOutputFile ) throw std::runtime_error( "Unable to write to " + m_sOutputFile );
+   }
+   std::ostream& oOutput = m_sOutputFile.empty() ? std::cout : oOutputFile;
+
    if( m_bVerbose ) std::cout << "Starting..." << std::endl;
-   CActiveSocket oClient;
 
-   bool retval = true;
+   ConnectionPool oPool( oConnector );
+   for( size_t ulNext = 0; ulNext < m_vecHrefs.size(); /* no increment */ )
+      ulNext += fetch( oPool, ulNext, oOutput );
+
+   if( !oOutput.flush() ) throw std::runtime_error( "Unable to write the response body" );
+
+   if( m_bVerbose ) std::cout << "Looked up " << oResolver.GetMisses() << " host names, " << oResolver.GetHits() << " more answered from cache..." << std::endl;
+   if( m_bVerbose ) std::cout << "Closing..." << std::endl;
+}
+
+// Requests the URL at the index given and returns how many URLs were answered. Over a connection the server already
+// kept open, the requests for the URLs that follow on the same host are pipelined behind it when allowed.
+size_t CurlAppController::fetch( ConnectionPool& pool, size_t index, std::ostream& output ) const
+{
+   if( m_bVerbose ) std::cout << "Connectioning to " << ConnectionPool::KeyOf( m_vecHrefs[ index ] ) << "..." << std::endl;
+   ConnectionPool::Connection oConnection = pool.Acquire( m_vecHrefs[ index ] );
+   if( m_bVerbose && oConnection.m_bReused ) std::cout << "Reusing a connection kept alive..." << std::endl;
+
+   // Only GETs are pipelined, whatever is not answered is sent again and a POST must not be
+   size_t ulBatch = 1;
+   if( m_bPipeline && oConnection.m_bReused && m_eCommand == Http::RequestMethod::Get )
+   {
+      while( index + ulBatch < m_vecHrefs.size() && ulBatch < MAX_PIPELINE_DEPTH &&
+             ConnectionPool::KeyOf( m_vecHrefs[ index + ulBatch ] ) == oConnection.m_sKey )
+         ulBatch += 1;
+   }
 
-   if( retval )
+   if( m_bVerbose ) std::cout << "Building Request..." << std::endl;
+   CActiveSocket& oSocket = *oConnection.m_pSocket;
+   const auto sendRaw = [ &oSocket ]( const std::string& raw ) { return oSocket.Send( (uint8_t*)raw.c_str(), raw.size() ) == static_cast<int32_t>( raw.size() ); };
+
+   // Requests are sent together, unless each has a file to follow its headers straight from disk
+   bool bSent = true;
+   std::string sRawRequests;
+   for( size_t ulOffset = 0; ulOffset < ulBatch && bSent; ulOffset += 1 )
    {
-      if( m_bVerbose ) std::cout << "Connectioning to " << m_oHref.m_sHostName << " on port " << 80 << "..." << std::endl;
-      retval = oClient.Open( m_oHref.m_sHostName.c_str(), m_oHref.m_nPortNumber );
+      const std::string sRawRequest = buildRequest( m_vecHrefs[ index + ulOffset ] );
+      if( m_bVerbose ) std::cout << "Raw request:" << std::endl << std::endl << sRawRequest << std::endl << std::endl;
+      sRawRequests.append( sRawRequest );
+
+      if( !m_oBodyFile.has_value() ) continue;
 
-      if( !retval && m_bVerbose ) std::cout << "Connection could not be established!" << std::endl;
+      if( m_bVerbose ) std::cout << "Sending " << m_oBodyFile->GetSize() << " bytes from file..." << std::endl;
+      bSent = sendRaw( sRawRequests ) && m_oBodyFile->SendTo( oSocket );
+      sRawRequests.clear();
    }
 
-   if( retval )
+   if( m_bVerbose && !sRawRequests.empty() ) std::cout << "Sending..." << std::endl;
+   bSent = bSent && ( sRawRequests.empty() || sendRaw( sRawRequests ) );
+
+   // Headers always go to the console, with a file for the body only when asked to be verbose
+   const bool bShowHeaders = m_sOutputFile.empty() || m_bVerbose;
+   const auto writeBody = [ &output ]( std::string_view data ) { output.write( data.data(), static_cast<std::streamsize>( data.size() ) ); };
+
+   // A compressed body is shown decoded, the headers still say how it was sent
+   std::unique_ptr<Http::ContentCoding::Decoder> pDecoder;
+   const auto showHeaders = [ this, bShowHeaders, &pDecoder, &writeBody ]( const HttpResponseStream& stream )
    {
-      if( m_bVerbose ) std::cout << "Building Request..." << std::endl;
-      HttpRequest oReq( m_eCommand, m_oHref.m_sUri, Http::Version::v10, m_oHref.m_sHostName + std::to_string( m_oHref.m_nPortNumber ) );
-      for( auto& oFeildNameAndValue : m_oExtraHeaders )
-      {
-         oReq.SetMessageHeader( oFeildNameAndValue.first, oFeildNameAndValue.second );
-      }
-      oReq.AppendMessageBody( m_sBody );
-      std::string sRawRequest = oReq.GetWireFormat();
+      if( m_bVerbose ) std::cout << std::endl << std::endl << "Here's the response!" << std::endl << std::endl;
+      if( bShowHeaders ) std::cout << stream.GetRawHeaders();
+      std::cout.flush();
 
-      if( m_bVerbose ) std::cout << "Raw request:" << std::endl << std::endl << sRawRequest << std::endl << std::endl << "Sending...";
-      retval = oClient.Send( (uint8_t*)sRawRequest.c_str(), sRawRequest.size() );
+      const auto oCoding = Http::ContentCoding::Parse( stream.GetHeaders().GetMessageHeader( "Content-Encoding" ) );
+      if( Http::ContentCoding::IS_AVAILABLE && oCoding.value_or( Http::ContentCoding::Coding::Identity ) != Http::ContentCoding::Coding::Identity )
+         pDecoder = std::make_unique<Http::ContentCoding::Decoder>( *oCoding, writeBody );
+   };
+   const auto decodeBody = [ &pDecoder, &writeBody ]( std::string_view data )
+   {
+      if( pDecoder != nullptr ) pDecoder->Feed( data );
+      else writeBody( data );
+   };
+
+   std::string sExcess;
+   size_t ulAnswered = 0;
+   bool bKeepAlive = true;
+   bool bAnythingShown = false;
+   while( bSent && bKeepAlive && ulAnswered < ulBatch )
+   {
+      pDecoder.reset();
+      HttpResponseStream oStream( decodeBody, showHeaders );
+      const bool bComplete = receiveResponse( *oConnection.m_pSocket, sExcess, oStream );
+      bAnythingShown = bAnythingShown || oStream.HasHeaders();
+      if( !bComplete ) break;
+      if( pDecoder != nullptr && !pDecoder->IsComplete() ) throw std::runtime_error( "Compressed body was cut short" );
+
+      ulAnswered += 1;
+      bKeepAlive = oStream.IsPersistent();
+      output.flush();
    }
 
-   HttpResponseParser oResponseParserParser;
-   if( retval )
+   if( ulAnswered == 0 )
    {
-      if( m_bVerbose ) std::cout << "Receiving..." << std::endl;
-      int32_t bytes_rcvd = -1;
-      do
-      {
-         bytes_rcvd = oClient.Receive( 1024 );
+      ConnectionPool::Close( oConnection );
+      // The server gave up on it while it was idle, try again on another. A POST may have been acted on all the same.
+      if( oConnection.m_bReused && !bAnythingShown && m_eCommand != Http::RequestMethod::Post ) return 0;
 
-         if( bytes_rcvd <= 0 ) break;
+      throw std::runtime_error( "No response from " + oConnection.m_sKey );
+   }
 
-         if( m_bVerbose ) std::cout << "Appending " << bytes_rcvd << " bytes of data..." << std::endl;
+   // Whatever was not answered is sent again over another connection
+   if( bKeepAlive && ulAnswered == ulBatch && sExcess.empty() )
+      pool.Release( std::move( oConnection ) );
+   else
+      ConnectionPool::Close( oConnection );
 
-      } while( !oResponseParserParser.AppendResponseData( oClient.GetData() ) );
+   return ulAnswered;
+}
 
-      if( m_bVerbose ) std::cout << "Transmission Completed..." << std::endl;
+std::string CurlAppController::buildRequest( const Href& href ) const
+{
+   HttpRequest oReq( m_eCommand, href.m_sUri, Http::Version::v11, ConnectionPool::KeyOf( href ) );
+   if( !Http::ContentCoding::AcceptEncoding().empty() ) oReq.SetMessageHeader( "Accept-Encoding", Http::ContentCoding::AcceptEncoding() ); // -h may say otherwise
+   for( auto& oFeildNameAndValue : m_oExtraHeaders )
+   {
+      oReq.SetMessageHeader( oFeildNameAndValue.first, oFeildNameAndValue.second );
    }
+   if( m_oBodyFile.has_value() )
+      oReq.SetMessageHeader( "Content-Length", std::to_string( m_oBodyFile->GetSize() ) ); // only the headers, the file is sent after
+   else
+      oReq.AppendMessageBody( m_sBody );
+
+   return oReq.GetWireFormat();
+}
+
+// Returns whether the response was complete. What arrived past its end is kept in excess, it starts the next
+// pipelined one.
+bool CurlAppController::receiveResponse( CActiveSocket& client, std::string& excess, HttpResponseStream& stream ) const
+{
+   if( m_bVerbose ) std::cout << "Receiving..." << std::endl;
+
+   if( !excess.empty() ) excess.erase( 0, stream.Feed( excess ) );
 
-   if( retval )
+   std::vector<uint8_t> vecBuffer( RECEIVE_BUFFER_SIZE );
+   while( !stream.IsComplete() )
    {
-      HttpResponse oRes = oResponseParserParser.GetHttpResponse();
+      const int32_t bytes_rcvd = client.Receive( static_cast<int32_t>( vecBuffer.size() ), vecBuffer.data() );
+      if( bytes_rcvd <= 0 ) return stream.Close(); // a body without a length ends with the connection
 
-      if( m_bVerbose ) std::cout << "Closing..." << std::endl;
-      oClient.Close();
-      if( m_bVerbose ) std::cout << std::endl << std::endl << "Here's the response!" << std::endl << std::endl;
+      if( m_bVerbose ) std::cout << "Appending " << bytes_rcvd << " bytes of data..." << std::endl;
 
-      std::cout << oRes.GetWireFormat();
-      std::cout.flush();
+      const std::string_view data( reinterpret_cast<const char*>( vecBuffer.data() ), static_cast<size_t>( bytes_rcvd ) );
+      const size_t ulUsed = stream.Feed( data );
+      if( ulUsed < data.size() ) excess.assign( data.substr( ulUsed ) );
    }
+
+   if( m_bVerbose ) std::cout << std::endl << "Transmission Completed..." << std::endl;
+
+   return true;
+}
+
+void CurlAppController::download( const Connector& connector ) const
+{
+   BatchDownloader::Options oOptions;
+   oOptions.m_uConnections = m_uConnections;
+   oOptions.m_sDirectory = m_sOutputDirectory;
+   oOptions.m_vecExtraHeaders = m_oExtraHeaders;
+   oOptions.m_bVerbose = m_bVerbose;
+
+   if( m_bVerbose ) std::cout << "Fetching " << m_vecHrefs.size() << " URLs over up to " << m_uConnections << " connections..." << std::endl;
+
+   const BatchDownloader::Summary oSummary = BatchDownloader( oOptions, connector ).Run( m_vecHrefs );
+
+   const double dSeconds = oSummary.m_Elapsed.count();
+   std::cout << oSummary.m_nSucceeded << " downloaded, " << oSummary.m_nFailed << " failed, " << oSummary.m_ulBytes << " bytes in "
+             << dSeconds << " s over " << oSummary.m_nConnects << " connections (" << ( dSeconds > 0 ? oSummary.m_ulBytes / dSeconds / 1024 : 0 )
+             << " KiB/s, " << ( dSeconds > 0 ? oSummary.m_nSucceeded / dSeconds : 0 ) << " files/s)" << std::endl;
+
+   if( oSummary.m_nFailed > 0 ) throw std::runtime_error( std::to_string( oSummary.m_nFailed ) + " of the URLs could not be fetched" );
 }
 
 //
@@ -141,29 +281,51 @@ void CurlAppController::printGeneralUsage()
 {
    std::cout << "General Usage\r\n   httpc help\r\nhttpc is a curl - like application but supports HTTP protocol only.\r\nUsage:\r\n   httpc command [ arguments ]\r\nThe commands are:\r\n";
    std::cout << "   get     executes a HTTP GET request and prints the response.\r\n   post    executes a HTTP POST request and prints the response.\r\n";
+   std::cout << "   fetch   downloads many URLs in parallel and saves them to files.\r\n";
    std::cout << "Other arguments are:\r\n   help    prints extremely helpful screen.\r\nUse 'httpc help [ command ]' for more information about a command." << std::endl;
 }
 
 void CurlAppController::printGetUsage()
 {
-   std::cout << "Get Usage\r\n   httpc help get\r\nGet executes a HTTP GET request for a given URL.\r\nUsage:\r\n   httpc get [ -v ] [ -h key:value ] URL\r\n";
+   std::cout << "Get Usage\r\n   httpc help get\r\nGet executes a HTTP GET request for each URL given.\r\nUsage:\r\n   httpc get [ -v ] [ -h key:value ] [ -p ] [ -t milliseconds ] [ -o file ] [ -l file ] URL...\r\n";
    std::cout << "-v             Prints the detail of the response such as protocol, status, and headers.\r\n";
-   std::cout << "-h key:value   Associates headers to the HTTP Request with the format 'key:value'. Can specify many in a row.\r\n" << std::endl;
+   std::cout << "-h key:value   Associates headers to the HTTP Request with the format 'key:value'. Can specify many in a row.\r\n";
+   std::cout << "-p             Pipelines the requests to a host once it has kept a connection open.\r\n";
+   std::cout << "-t milliseconds Gives up connecting to a host after this long, by default 5000.\r\n";
+   std::cout << "-o file        Writes the response bodies to a file instead of the console.\r\n";
+   std::cout << "-l file        Reads more URLs from a file, one per line.\r\n" << std::endl;
 }
 
 void CurlAppController::printPostUsage()
 {
-   std::cout << "Post Usage\r\nhttpc help post\r\nPost executes a HTTP POST request for a given URL with inline data or from file.\r\nUsage:\r\n";
-   std::cout << "   httpc post [ -v ] [ -h key:value ] [ -d inline-data | -f file ] URL\r\n";
+   std::cout << "Post Usage\r\nhttpc help post\r\nPost executes a HTTP POST request for each URL given with inline data or from file.\r\nUsage:\r\n";
+   std::cout << "   httpc post [ -v ] [ -h key:value ] [ -t milliseconds ] [ -o file ] [ -l file ] [ -d inline-data | -f file ] URL...\r\n";
    std::cout << "-v             Prints the detail of the response such as protocol, status,and headers.\r\n";
    std::cout << "-h key:value   Associates headers to HTTP Request with the format 'key:value'. Can specify many in a row.\r\n";
+   std::cout << "-t milliseconds Gives up connecting to a host after this long, by default 5000.\r\n";
+   std::cout << "-o file        Writes the response bodies to a file instead of the console.\r\n";
+   std::cout << "-l file        Reads more URLs from a file, one per line.\r\n";
    std::cout << "-d string      Associates an inline data to the body HTTP POST request.\r\n";
    std::cout << "-f file        Associates the content of a file to the body HTTP POST request.\r\n";
    std::cout << "Either [ -d ] or [ -f ] can be used but not both." << std::endl;
 }
 
+void CurlAppController::printFetchUsage()
+{
+   std::cout << "Fetch Usage\r\n   httpc help fetch\r\nFetch downloads every URL given over several connections at once and saves each body to a file.\r\nUsage:\r\n";
+   std::cout << "   httpc fetch [ -v ] [ -h key:value ] [ -c connections ] [ -t milliseconds ] [ -o directory ] [ -l file ] URL...\r\n";
+   std::cout << "-v             Prints each file as it is saved.\r\n";
+   std::cout << "-h key:value   Associates headers to every HTTP Request with the format 'key:value'. Can specify many in a row.\r\n";
+   std::cout << "-c connections Opens at most this many connections at once, by default 8.\r\n";
+   std::cout << "-t milliseconds Gives up connecting to a host after this long, by default 5000.\r\n";
+   std::cout << "-o directory   Saves the files under this directory in one per host following the path of their URL, by default the current one.\r\n";
+   std::cout << "-l file        Reads more URLs from a file, one per line." << std::endl;
+}
+
 void CurlAppController::printUsageGivenArgs() const
 {
+   if( m_bFetch ) return printFetchUsage();
+
    switch( m_eCommand )
    {
    case Http::RequestMethod::Get: printGetUsage(); break;
@@ -179,13 +341,20 @@ void CurlAppController::parseGetOptions( CommandLineParser::ArgIterator itor )
 {
    parseVerboseOption( itor );
    parseHeaderOption( itor );
-   parseUrlOption( itor );
+   parsePipelineOption( itor );
+   parseConnectTimeoutOption( itor );
+   parseOutputFileOption( itor );
+   parseUrlListOption( itor );
+   parseUrlOptions( itor );
 }
 
 void CurlAppController::parsePostOptions( CommandLineParser::ArgIterator itor )
 {
    parseVerboseOption( itor );
    parseHeaderOption( itor );
+   parseConnectTimeoutOption( itor );
+   parseOutputFileOption( itor );
+   parseUrlListOption( itor );
 
    moreArgsToRead( itor, MISSING_URL );
 
@@ -200,18 +369,31 @@ void CurlAppController::parsePostOptions( CommandLineParser::ArgIterator itor )
    {
       moreArgsToRead( ++itor, MISSING_URL );
 
-      std::ifstream fileReader( *itor, std::ios::in | std::ios::binary | std::ios::ate );
-      if( !fileReader ) { printPostUsage(); throw std::invalid_argument( "Unable to use file specified with -f switch" ); }
-
-      const size_t size = fileReader.tellg();
-      m_sBody.resize( size + 1, '\0' ); // construct buffer
-      fileReader.seekg( 0 ); // rewind
-      fileReader.read( m_sBody.data(), size );
+      try
+      {
+         m_oBodyFile.emplace( *itor );
+      }
+      catch( const std::invalid_argument& )
+      {
+         printPostUsage();
+         throw std::invalid_argument( "Unable to use file specified with -f switch" );
+      }
 
       ++itor;
    }
 
-   parseUrlOption( itor );
+   parseUrlOptions( itor );
+}
+
+void CurlAppController::parseFetchOptions( CommandLineParser::ArgIterator itor )
+{
+   parseVerboseOption( itor );
+   parseHeaderOption( itor );
+   parseConnectionsOption( itor );
+   parseConnectTimeoutOption( itor );
+   parseOutputDirectoryOption( itor );
+   parseUrlListOption( itor );
+   parseUrlOptions( itor );
 }
 
 void CurlAppController::parseVerboseOption( CommandLineParser::ArgIterator& itor )
@@ -242,19 +424,135 @@ void CurlAppController::parseHeaderOption( CommandLineParser::ArgIterator& itor
    }
 }
 
-void CurlAppController::parseUrlOption( CommandLineParser::ArgIterator & itor )
+void CurlAppController::parsePipelineOption( CommandLineParser::ArgIterator& itor )
 {
    moreArgsToRead( itor, MISSING_URL );
 
+   if( *itor == "-p" )
+   {
+      m_bPipeline = true;
+      ++itor;
+   }
+}
+
+void CurlAppController::parseConnectionsOption( CommandLineParser::ArgIterator& itor )
+{
+   moreArgsToRead( itor, MISSING_URL );
+
+   if( *itor != "-c" ) return;
+
+   moreArgsToRead( ++itor, MISSING_URL );
+
+   try
+   {
+      const int iConnections = std::stoi( *itor );
+      if( iConnections < 1 ) throw std::out_of_range( "connections" );
+      m_uConnections = static_cast<unsigned>( iConnections );
+   }
+   catch( const std::logic_error& )
+   {
+      printUsageGivenArgs();
+      throw std::invalid_argument( "Expected a positive number of connections with -c switch" );
+   }
+
+   ++itor;
+}
+
+void CurlAppController::parseConnectTimeoutOption( CommandLineParser::ArgIterator& itor )
+{
+   moreArgsToRead( itor, MISSING_URL );
+
+   if( *itor != "-t" ) return;
+
+   moreArgsToRead( ++itor, MISSING_URL );
+
    try
    {
-      m_oHref = HrefParser().Parse( *itor ).GetHref();
+      const int iMilliseconds = std::stoi( *itor );
+      if( iMilliseconds < 1 ) throw std::out_of_range( "timeout" );
+      m_ConnectTimeout = std::chrono::milliseconds( iMilliseconds );
    }
-   catch( const HrefParser::ParseError& e )
+   catch( const std::logic_error& )
    {
       printUsageGivenArgs();
-      throw e;
+      throw std::invalid_argument( "Expected a positive number of milliseconds with -t switch" );
    }
+
+   ++itor;
+}
+
+void CurlAppController::parseOutputDirectoryOption( CommandLineParser::ArgIterator& itor )
+{
+   moreArgsToRead( itor, MISSING_URL );
+
+   if( *itor != "-o" ) return;
+
+   moreArgsToRead( ++itor, MISSING_URL );
+
+   m_sOutputDirectory = *itor;
+   ++itor;
+}
+
+void CurlAppController::parseOutputFileOption( CommandLineParser::ArgIterator& itor )
+{
+   moreArgsToRead( itor, MISSING_URL );
+
+   if( *itor != "-o" ) return;
+
+   moreArgsToRead( ++itor, MISSING_URL );
+
+   m_sOutputFile = *itor;
+   ++itor;
+}
+
+void CurlAppController::parseUrlListOption( CommandLineParser::ArgIterator& itor )
+{
+   moreArgsToRead( itor, MISSING_URL );
+
+   if( *itor != "-l" ) return;
+
+   moreArgsToRead( ++itor, MISSING_URL );
+
+   std::ifstream fileReader( *itor );
+   if( !fileReader ) { printUsageGivenArgs(); throw std::invalid_argument( "Unable to use file specified with -l switch" ); }
+
+   for( std::string sLine; std::getline( fileReader, sLine ); )
+   {
+      if( !sLine.empty() && sLine.back() == '\r' ) sLine.pop_back();
+      if( sLine.empty() ) continue;
+
+      try
+      {
+         m_vecHrefs.push_back( HrefParser().Parse( sLine ).GetHref() );
+      }
+      catch( const HrefParser::ParseError& e )
+      {
+         printUsageGivenArgs();
+         throw e;
+      }
+   }
+
+   ++itor;
+}
+
+void CurlAppController::parseUrlOptions( CommandLineParser::ArgIterator & itor )
+{
+   if( m_vecHrefs.empty() ) moreArgsToRead( itor, MISSING_URL ); // a list file may have given them all
+
+   for( ; itor != m_oCliParser.cend(); ++itor )
+   {
+      try
+      {
+         m_vecHrefs.push_back( HrefParser().Parse( *itor ).GetHref() );
+      }
+      catch( const HrefParser::ParseError& e )
+      {
+         printUsageGivenArgs();
+         throw e;
+      }
+   }
+
+   if( m_vecHrefs.empty() ) { printUsageGivenArgs(); throw std::invalid_argument( MISSING_URL.data() ); }
 }
 
 void CurlAppController::moreArgsToRead( CommandLineParser::ArgIterator itor, std::string_view errMsg ) const
@@ -31,6 +31,14 @@ SOFTWARE.
 #include "HttpResponse.h"
 #include "HttpRequest.h"
 #include "Href.h"
+#include "ConnectionPool.h"
+#include "Connector.h"
+#include "Resolver.h"
+#include "HttpResponseStream.h"
+#include "FileBody.h"
+#include <chrono>
+#include <optional>
+#include <ostream>
 
 class CurlAppController final
 {
@@ -43,25 +51,48 @@ private:
    CommandLineParser m_oCliParser;
    Http::RequestMethod m_eCommand;
    bool              m_bVerbose;
+   bool              m_bPipeline;
+   bool              m_bFetch;
+   unsigned          m_uConnections;
+   std::string       m_sOutputDirectory;
+   std::string       m_sOutputFile;
+   std::chrono::milliseconds m_ConnectTimeout;
    std::vector<std::pair<std::string, std::string>> m_oExtraHeaders;
-   Href              m_oHref{};
+   std::vector<Href> m_vecHrefs;
    std::string       m_sBody;
+   std::optional<FileBody> m_oBodyFile; // sent in place of m_sBody
+
+   static constexpr size_t MAX_PIPELINE_DEPTH = 16;
+   static constexpr size_t RECEIVE_BUFFER_SIZE = 64 * 1024;
+
+   size_t fetch( ConnectionPool& pool, size_t index, std::ostream& output ) const;
+   std::string buildRequest( const Href& href ) const;
+   bool receiveResponse( CActiveSocket& client, std::string& excess, HttpResponseStream& stream ) const;
+   void download( const Connector& connector ) const;
 
    void readCommandLineArgs();
 
    static void printGeneralUsage();
    static void printGetUsage();
    static void printPostUsage();
+   static void printFetchUsage();
    void printUsageGivenArgs() const;
 
    void parseGetOptions( CommandLineParser::ArgIterator itor );
    void parsePostOptions( CommandLineParser::ArgIterator itor );
+   void parseFetchOptions( CommandLineParser::ArgIterator itor );
 
    void parseVerboseOption( CommandLineParser::ArgIterator& itor );
    void parseHeaderOption( CommandLineParser::ArgIterator& itor );
-   void parseUrlOption( CommandLineParser::ArgIterator& itor );
-
-   static constexpr std::string_view MISSING_GET_OR_POST = "Missing 'get' or 'post' paramater";
+   void parsePipelineOption( CommandLineParser::ArgIterator& itor );
+   void parseUrlListOption( CommandLineParser::ArgIterator& itor );
+   void parseConnectionsOption( CommandLineParser::ArgIterator& itor );
+   void parseConnectTimeoutOption( CommandLineParser::ArgIterator& itor );
+   void parseOutputDirectoryOption( CommandLineParser::ArgIterator& itor );
+   void parseOutputFileOption( CommandLineParser::ArgIterator& itor );
+   void parseUrlOptions( CommandLineParser::ArgIterator& itor );
+
+   static constexpr std::string_view MISSING_GET_OR_POST = "Missing 'get', 'post' or 'fetch' paramater";
    static constexpr std::string_view MISSING_URL = "Missing 'URL' paramater";
    void moreArgsToRead( CommandLineParser::ArgIterator itor, std::string_view errMsg ) const;
 };
@@ -0,0 +1,107 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Chris McArthur, prince.chrismc(at)gmail(dot)com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "FileBody.h"
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+#include <sys/stat.h>
+
+#ifdef __linux__
+#include <sys/sendfile.h>
+#include <cerrno>
+#endif
+
+// The Content-Length comes from the file system rather than from reading the file, which only a regular file can be
+// trusted with. A pipe says 0 whatever comes through it and a directory can not be read at all.
+static bool statFile( FILE* file, uint64_t& size, bool& regular )
+{
+#ifdef _WIN32
+   struct _stat64 oStat;
+   if( _fstat64( _fileno( file ), &oStat ) != 0 ) return false;
+   regular = ( oStat.st_mode & _S_IFMT ) == _S_IFREG;
+#else
+   struct stat oStat;
+   if( fstat( fileno( file ), &oStat ) != 0 ) return false;
+   regular = S_ISREG( oStat.st_mode );
+#endif
+
+   size = static_cast<uint64_t>( oStat.st_size );
+   return true;
+}
+
+FileBody::FileBody( const std::string& path ) : m_pFile( std::fopen( path.c_str(), "rb" ) ), m_ulSize( 0 )
+{
+   if( m_pFile == nullptr ) throw std::invalid_argument( "Unable to open " + path );
+
+   bool bRegular = false;
+   if( !statFile( m_pFile, m_ulSize, bRegular ) )
+   {
+      std::fclose( m_pFile );
+      throw std::invalid_argument( "Unable to read the size of " + path );
+   }
+
+   if( !bRegular )
+   {
+      std::fclose( m_pFile );
+      throw std::invalid_argument( path + " is not a regular file" );
+   }
+}
+
+FileBody::~FileBody()
+{
+   std::fclose( m_pFile );
+}
+
+bool FileBody::SendTo( CActiveSocket& socket ) const
+{
+#ifdef __linux__
+   // The kernel copies from the page cache to the socket, the bytes never pass through this process
+   off_t lOffset = 0;
+   while( static_cast<uint64_t>( lOffset ) < m_ulSize )
+   {
+      const ssize_t lSent = sendfile( socket.GetSocketDescriptor(), fileno( m_pFile ), &lOffset, static_cast<size_t>( m_ulSize - lOffset ) );
+      if( lSent < 0 && errno == EINTR ) continue;
+      if( lSent <= 0 ) return false;
+   }
+
+   return true;
+#else
+   if( std::fseek( m_pFile, 0, SEEK_SET ) != 0 ) return false;
+
+   std::vector<uint8_t> vecBuffer( READ_BUFFER_SIZE );
+   for( uint64_t ulLeft = m_ulSize; ulLeft > 0; )
+   {
+      const size_t ulRead = std::fread( vecBuffer.data(), 1, static_cast<size_t>( std::min<uint64_t>( ulLeft, vecBuffer.size() ) ), m_pFile );
+      if( ulRead == 0 ) return false; // the file shrank since it was opened
+
+      if( socket.Send( vecBuffer.data(), ulRead ) != static_cast<int32_t>( ulRead ) ) return false;
+      ulLeft -= ulRead;
+   }
+
+   return true;
+#endif
+}
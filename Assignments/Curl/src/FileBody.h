@@ -0,0 +1,57 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Chris McArthur, prince.chrismc(at)gmail(dot)com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#pragma once
+
+#include "ActiveSocket.h"
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+//
+// A file sent as a request body straight from disk, it is never held in memory. Its size is taken once when it is
+// opened and that many bytes are sent every time, so each pipelined request carries the same body.
+//
+class FileBody
+{
+public:
+   explicit FileBody( const std::string& path ); // throws std::invalid_argument when it cannot be read
+   ~FileBody();
+
+   FileBody( const FileBody& ) = delete;
+   FileBody& operator=( const FileBody& ) = delete;
+
+   uint64_t GetSize() const { return m_ulSize; }
+
+   // The whole file from its start, false when the connection did not take all of it
+   bool SendTo( CActiveSocket& socket ) const;
+
+private:
+   FILE* m_pFile;
+   uint64_t m_ulSize;
+
+   static constexpr size_t READ_BUFFER_SIZE = 64 * 1024;
+};
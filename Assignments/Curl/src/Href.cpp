@@ -25,37 +25,22 @@ SOFTWARE.
 */
 
 #include "Href.h"
-#include <algorithm>
-#include <string_view>
+#include "Url.h"
 
-using namespace std::string_view_literals;
-
-constexpr auto PROTOCOL_ENDING = "://"sv;
-
-HrefParser& HrefParser::Parse( const std::string& fullUrl )
+HrefParser& HrefParser::Parse( std::string_view fullUrl )
 {
-   size_t ulProtocol = fullUrl.find( PROTOCOL_ENDING );
-   if( ulProtocol == std::string::npos )
-      throw ParseError( "URL missing protocol seperator" );
-
-   m_Href.m_sProtocol = fullUrl.substr( 0, ulProtocol );
-
-   ulProtocol += PROTOCOL_ENDING.length();
-
-   const size_t ulColumn = fullUrl.find( ':', ulProtocol );
-   const size_t ulSlash = fullUrl.find( '/', ulProtocol );
-
-   const size_t ulEndOfHostName = std::min( ulColumn, ulSlash );
-   m_Href.m_sHostName = fullUrl.substr( ulProtocol, ulEndOfHostName - ulProtocol );
-
-   if( m_Href.m_sHostName.empty() )
-      throw ParseError( "Unable to determine host name or IP addr" );
-
-   if( ulColumn != std::string::npos && ulSlash != std::string::npos )
-      m_Href.m_nPortNumber = static_cast<unsigned short>( std::stoul( fullUrl.substr( ulColumn + 1, ulSlash - ulColumn - 1 ) ) );
-
-   if( ulEndOfHostName != std::string::npos )
-      m_Href.m_sUri = fullUrl.substr( ulSlash );
+   const std::optional<Http::Url> oUrl = Http::Url::Parse( fullUrl );
+   if( !oUrl.has_value() )
+      throw ParseError( "URL must be scheme://host[:port][/path][?query]" );
+
+   m_Href.m_sProtocol = oUrl->m_sScheme;
+   m_Href.m_sHostName = oUrl->m_sHost;
+   m_Href.m_nPortNumber = oUrl->m_sPort.empty() ? Http::Url::DefaultPortOf( oUrl->m_sScheme ) : oUrl->m_nPort;
+   if( m_Href.m_nPortNumber == 0 )
+      throw ParseError( "Unable to determine the port for " + m_Href.m_sProtocol );
+
+   const std::string_view sTarget = oUrl->GetPathAndQuery();
+   m_Href.m_sUri.assign( sTarget.empty() || sTarget.front() != '/' ? "/" : "" ).append( sTarget );
 
    return *this;
 }
@@ -28,13 +28,14 @@ SOFTWARE.
 
 #include <stdexcept>
 #include <string>
+#include <string_view>
 
 struct Href
 {
    std::string m_sProtocol;
-   std::string m_sHostName;
+   std::string m_sHostName; // an IPv6 literal without its brackets
    unsigned short m_nPortNumber;
-   std::string m_sUri;
+   std::string m_sUri;      // the path and query, never the fragment
 };
 
 class HrefParser
@@ -42,7 +43,7 @@ class HrefParser
 public:
    HrefParser() = default;
 
-   HrefParser& Parse( const std::string& fullUrl );
+   HrefParser& Parse( std::string_view fullUrl );
 
    const Href& GetHref() const { return m_Href; }
 
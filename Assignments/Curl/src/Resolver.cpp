@@ -0,0 +1,134 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Chris McArthur, prince.chrismc(at)gmail(dot)com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "Resolver.h"
+#include <algorithm>
+#include <cstring>
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#endif
+
+static void setPort( Resolver::Address& address, uint16_t port )
+{
+   if( address.GetFamily() == AF_INET6 )
+      reinterpret_cast<sockaddr_in6&>( address.m_Storage ).sin6_port = htons( port );
+   else
+      reinterpret_cast<sockaddr_in&>( address.m_Storage ).sin_port = htons( port );
+}
+
+std::string Resolver::Address::ToString() const
+{
+   char szAddress[ INET6_ADDRSTRLEN ] = {};
+   const void* pAddress = ( GetFamily() == AF_INET6 ) ? static_cast<const void*>( &reinterpret_cast<const sockaddr_in6&>( m_Storage ).sin6_addr )
+                                                      : static_cast<const void*>( &reinterpret_cast<const sockaddr_in&>( m_Storage ).sin_addr );
+   if( inet_ntop( GetFamily(), pAddress, szAddress, sizeof( szAddress ) ) == nullptr ) return "?";
+
+   return ( GetFamily() == AF_INET6 ) ? "[" + std::string( szAddress ) + "]" : std::string( szAddress );
+}
+
+Resolver::Resolver( std::chrono::seconds ttl ) : m_Ttl( ttl )
+{
+}
+
+std::vector<Resolver::Address> Resolver::Resolve( const std::string& host, uint16_t port )
+{
+   std::vector<Address> vecAddresses;
+   {
+      std::lock_guard<std::mutex> oLock( m_Mutex );
+      const auto itor = m_mapEntries.find( host );
+      if( itor != m_mapEntries.end() && itor->second.m_tExpires > std::chrono::steady_clock::now() )
+      {
+         m_nHits += 1;
+         vecAddresses = itor->second.m_vecAddresses;
+      }
+   }
+
+   // Looked up without holding the lock, two threads missing at once both ask and the last answer is kept
+   if( vecAddresses.empty() )
+   {
+      vecAddresses = lookup( host );
+
+      std::lock_guard<std::mutex> oLock( m_Mutex );
+      m_nMisses += 1;
+      if( vecAddresses.empty() ) return vecAddresses;
+
+      m_mapEntries[ host ] = Entry{ vecAddresses, std::chrono::steady_clock::now() + m_Ttl };
+   }
+
+   for( auto& oAddress : vecAddresses ) setPort( oAddress, port );
+
+   return vecAddresses;
+}
+
+size_t Resolver::GetHits() const
+{
+   std::lock_guard<std::mutex> oLock( m_Mutex );
+   return m_nHits;
+}
+
+size_t Resolver::GetMisses() const
+{
+   std::lock_guard<std::mutex> oLock( m_Mutex );
+   return m_nMisses;
+}
+
+std::vector<Resolver::Address> Resolver::lookup( const std::string& host )
+{
+   addrinfo oHints{};
+   oHints.ai_family = AF_UNSPEC;
+   oHints.ai_socktype = SOCK_STREAM;
+   oHints.ai_flags = AI_ADDRCONFIG;
+
+   addrinfo* pResults = nullptr;
+   if( getaddrinfo( host.c_str(), nullptr, &oHints, &pResults ) != 0 ) return {};
+
+   // getaddrinfo already sorts by preference ( RFC 6724 ), the families are then taken in turn starting with the first
+   std::vector<Address> vecPreferred;
+   std::vector<Address> vecOther;
+   for( const addrinfo* pResult = pResults; pResult != nullptr; pResult = pResult->ai_next )
+   {
+      if( pResult->ai_family != AF_INET && pResult->ai_family != AF_INET6 ) continue;
+
+      Address oAddress{};
+      std::memcpy( &oAddress.m_Storage, pResult->ai_addr, pResult->ai_addrlen );
+      oAddress.m_nLength = static_cast<socklen_t>( pResult->ai_addrlen );
+
+      ( vecPreferred.empty() || vecPreferred.front().GetFamily() == pResult->ai_family ? vecPreferred : vecOther ).push_back( oAddress );
+   }
+   freeaddrinfo( pResults );
+
+   std::vector<Address> vecAddresses;
+   for( size_t ulIndex = 0; ulIndex < std::max( vecPreferred.size(), vecOther.size() ); ulIndex += 1 )
+   {
+      if( ulIndex < vecPreferred.size() ) vecAddresses.push_back( vecPreferred[ ulIndex ] );
+      if( ulIndex < vecOther.size() ) vecAddresses.push_back( vecOther[ ulIndex ] );
+   }
+
+   return vecAddresses;
+}
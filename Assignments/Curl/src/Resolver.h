@@ -0,0 +1,84 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Chris McArthur, prince.chrismc(at)gmail(dot)com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <sys/socket.h>
+#endif
+
+//
+// Host names resolved once and then remembered for a while, so repeated connections to the same host skip the lookup.
+// getaddrinfo does not say how long its answer is good for, every entry lives for the same configured time. Safe to
+// share between every thread of the process.
+//
+class Resolver
+{
+public:
+   struct Address
+   {
+      sockaddr_storage m_Storage;
+      socklen_t m_nLength;
+
+      int GetFamily() const { return m_Storage.ss_family; }
+      std::string ToString() const;
+   };
+
+   explicit Resolver( std::chrono::seconds ttl = std::chrono::seconds( 60 ) );
+
+   // Every address of the host with the port set, families alternating as happy eyeballs ( RFC 8305 ) wants them.
+   // Empty when the host cannot be resolved, failures are not remembered.
+   std::vector<Address> Resolve( const std::string& host, uint16_t port );
+
+   size_t GetHits() const;
+   size_t GetMisses() const;
+
+private:
+   struct Entry
+   {
+      std::vector<Address> m_vecAddresses; // the port is left at 0
+      std::chrono::steady_clock::time_point m_tExpires;
+   };
+
+   const std::chrono::seconds m_Ttl;
+
+   mutable std::mutex m_Mutex;
+   std::unordered_map<std::string, Entry> m_mapEntries;
+   size_t m_nHits = 0;
+   size_t m_nMisses = 0;
+
+   static std::vector<Address> lookup( const std::string& host );
+};
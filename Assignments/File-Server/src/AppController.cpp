@@ -25,20 +25,36 @@ SOFTWARE.
 */
 
 #include "AppController.h"
+#include <atomic>
+#include <csignal>
 #include <iostream>
 #include <thread>
 #include "IconServlet.h"
 #include "FileServlet.h"
+#include "StaticHttpServer.h"
 
 using namespace std::chrono_literals;
 
-AppController::AppController( int argc, char ** argv ) : m_CliParser( argc, argv ), m_Verbose( false ), m_Port( 8080 ), m_FileExplorerRoot( "." )
+static constexpr char FILE_EXPLORER_URI[] = "/";
+static constexpr char FAVICON_URI[] = "/favicon.ico";
+using FileExplorerRoute = StaticRoute<FILE_EXPLORER_URI, FileServlet>;
+using FaviconRoute = StaticRoute<FAVICON_URI, IconServlet>;
+
+static std::atomic<bool> s_bStopRequested( false );
+
+static void requestStop( int /* signal */ )
+{
+   s_bStopRequested = true;
+}
+
+AppController::AppController( int argc, char ** argv ) : m_CliParser( argc, argv ), m_Verbose( false ), m_StaticRoutes( false ), m_Port( 8080 ), m_FileExplorerRoot( "." )
 {
 }
 
 void AppController::Initialize()
 {
    m_Verbose = m_CliParser.DoesSwitchExists( "-v" );
+   m_StaticRoutes = m_CliParser.DoesSwitchExists( "-s" );
 
    if( m_CliParser.DoesSwitchExists( "-p" ) )
    {
@@ -53,6 +69,89 @@ void AppController::Initialize()
       }
    }
 
+   if( m_CliParser.DoesSwitchExists( "-a" ) )
+   {
+      try
+      {
+         m_Placement.m_uAcceptors = static_cast<unsigned>( std::stoul( *++m_CliParser.find( "-a" ) ) );
+      }
+      catch( ... )
+      {
+         printGeneralUsage();
+         throw std::logic_error( "Invalid number of acceptors specified!" );
+      }
+   }
+
+   if( m_CliParser.DoesSwitchExists( "-w" ) )
+   {
+      try
+      {
+         m_Placement.m_uConnectionsPerAcceptor = static_cast<uint32_t>( std::stoul( *++m_CliParser.find( "-w" ) ) );
+      }
+      catch( ... )
+      {
+         printGeneralUsage();
+         throw std::logic_error( "Invalid number of connections specified!" );
+      }
+   }
+
+   if( m_CliParser.DoesSwitchExists( "-c" ) )
+   {
+      try
+      {
+         m_Placement.m_vecCpus = CpuTopology::ParseCpuList( *++m_CliParser.find( "-c" ) );
+         if( m_Placement.m_vecCpus.empty() ) throw std::invalid_argument( "no CPUs" );
+      }
+      catch( ... )
+      {
+         printGeneralUsage();
+         throw std::logic_error( "Invalid list of CPUs specified!" );
+      }
+   }
+
+   m_Placement.m_bNodeLocal = !m_CliParser.DoesSwitchExists( "-n" );
+
+   if( m_CliParser.DoesSwitchExists( "-l" ) )
+   {
+      try
+      {
+         m_AccessLog.m_sPath = *++m_CliParser.find( "-l" );
+      }
+      catch( ... )
+      {
+         printGeneralUsage();
+         throw std::logic_error( "Incorrectly specified access log!" );
+      }
+   }
+
+   if( m_CliParser.DoesSwitchExists( "-r" ) )
+   {
+      try
+      {
+         m_AccessLog.m_uSampleEvery = static_cast<unsigned>( std::stoul( *++m_CliParser.find( "-r" ) ) );
+         if( m_AccessLog.m_uSampleEvery == 0 ) throw std::invalid_argument( "zero" );
+      }
+      catch( ... )
+      {
+         printGeneralUsage();
+         throw std::logic_error( "Invalid access log sampling rate specified!" );
+      }
+   }
+
+   if( m_CliParser.DoesSwitchExists( "-m" ) )
+   {
+      try
+      {
+         m_MetricsUri = *++m_CliParser.find( "-m" );
+         if( m_MetricsUri.empty() || m_MetricsUri.front() != '/' ) throw std::invalid_argument( "relative" );
+      }
+      catch( ... )
+      {
+         printGeneralUsage();
+         throw std::logic_error( "Incorrectly specified metrics URI!" );
+      }
+   }
+
    if( m_CliParser.DoesSwitchExists( "-d" ) )
    {
       try
@@ -82,28 +181,58 @@ void AppController::Initialize()
 
 void AppController::Run()
 {
-   HttpServer oServer;
    std::unique_ptr<FileServlet> oFileExplorer = std::make_unique<FileServlet>( m_FileExplorerRoot );
-   oServer.RegisterServlet( "/", oFileExplorer.get() );
 
    std::unique_ptr<IconServlet> oFavicon;
    if( m_FaviconPath.length() )
-   {
       oFavicon = std::make_unique<IconServlet>( m_FaviconPath );
-      oServer.RegisterServlet( "/favicon.ico", oFavicon.get() );
+
+   std::unique_ptr<HttpServer> pServer;
+   if( m_StaticRoutes )
+   {
+      if( oFavicon )
+         pServer = std::make_unique<StaticHttpServer<FaviconRoute, FileExplorerRoute>>( Http::Version::v11, *oFavicon, *oFileExplorer );
+      else
+         pServer = std::make_unique<StaticHttpServer<FileExplorerRoute>>( Http::Version::v11, *oFileExplorer );
    }
+   else
+   {
+      pServer = std::make_unique<HttpServer>();
+      pServer->RegisterServlet( "/", oFileExplorer.get() );
+
+      if( oFavicon )
+         pServer->RegisterServlet( "/favicon.ico", oFavicon.get() );
+   }
+
+   HttpServer& oServer = *pServer;
+
+   if( m_MetricsUri.length() && !oServer.ServeMetrics( m_MetricsUri.c_str() ) )
+      throw std::logic_error( "Unable to serve metrics at " + m_MetricsUri );
+
+   if( m_Verbose || m_CliParser.DoesSwitchExists( "-l" ) )
+      Http::AccessLog::Open( m_AccessLog );
 
    if( m_Verbose )
       std::cout << "Successfully created sevlets" <<std::endl;
 
-   oServer.Launch( m_Port );
+   oServer.Launch( m_Port, m_Placement );
 
    if( m_Verbose )
       std::cout << "Successfully launch http server now ready to answer!" <<std::endl;
 
-   std::this_thread::sleep_for( 1h );
+   // Serves for an hour at most, a deploy stopping us gets the requests in flight answered first
+   std::signal( SIGINT, requestStop );
+   std::signal( SIGTERM, requestStop );
+
+   const auto tStop = std::chrono::steady_clock::now() + 1h;
+   while( !s_bStopRequested && std::chrono::steady_clock::now() < tStop )
+      std::this_thread::sleep_for( 100ms );
+
+   if( m_Verbose )
+      std::cout << "Draining connections before closing" << std::endl;
 
    oServer.Close();
+   Http::AccessLog::Close();
 }
 
 //
@@ -116,15 +245,30 @@ void AppController::printGeneralUsage()
     *    httpfs help
     * httpfs is a simple HTTP based file server.
     * usage:
-    *    httpfs [-v] [-p PORT] [-d PATH-TO-DIR] [-i ICON-PATH]
+    *    httpfs [-v] [-s] [-p PORT] [-a COUNT] [-w COUNT] [-c CPU-LIST] [-n] [-l LOG-PATH] [-r RATE] [-m URI] [-d PATH-TO-DIR] [-i ICON-PATH]
     * -v Prints debugging messages.
+    * -s Routes requests through the table built at compile time rather than the one filled at runtime.
     * -p Specifies the port number that the server will listen and serve at. Default is 8080.
+    * -a Specifies how many listeners share the port, each accepting on its own core. Default is 1.
+    * -w Specifies how many connections each listener serves at once, each on a thread of its own. Default is 4096.
+    * -c Specifies the CPUs the server may run on, for instance 0-7,16-23. Default is every CPU available.
+    * -n Lets connections be served on any of those CPUs rather than on the NUMA node they were accepted on.
+    * -l Writes the access log to this file rather than the standard output, logging even without -v.
+    * -r Keeps one access log record out of every RATE. Default is 1, every request is logged.
+    * -m Serves latency percentiles and counters for Prometheus at this URI.
     * -d Specifies the directory that the server will use to read/write requested files. Default is the current directory when launching the application.
     * -i Specifies the path to the favorite icon saved in a PNG format.
     */
 
-   std::cout << "General Usage\r\n   httpfs help\r\nhttpfs is a simple file server.\r\nUsage:\r\n   hhttpfs [-v] [-p PORT] [-d PATH-TO-DIR] [-i ICON-PATH]\r\n";
-   std::cout << "-v   Prints debugging messages.\r\n-p Specifies the port number that the server will listen and serve at. Default is 8080.\r\n";
+   std::cout << "General Usage\r\n   httpfs help\r\nhttpfs is a simple file server.\r\nUsage:\r\n   hhttpfs [-v] [-s] [-p PORT] [-a COUNT] [-w COUNT] [-c CPU-LIST] [-n] [-l LOG-PATH] [-r RATE] [-m URI] [-d PATH-TO-DIR] [-i ICON-PATH]\r\n";
+   std::cout << "-v   Prints debugging messages.\r\n-s Routes requests through the table built at compile time rather than the one filled at runtime.\r\n-p Specifies the port number that the server will listen and serve at. Default is 8080.\r\n";
+   std::cout << "-a Specifies how many listeners share the port, each accepting on its own core. Default is 1.\r\n";
+   std::cout << "-w Specifies how many connections each listener serves at once, each on a thread of its own. Default is 4096.\r\n";
+   std::cout << "-c Specifies the CPUs the server may run on, for instance 0-7,16-23. Default is every CPU available.\r\n";
+   std::cout << "-n Lets connections be served on any of those CPUs rather than on the NUMA node they were accepted on.\r\n";
+   std::cout << "-l Writes the access log to this file rather than the standard output, logging even without -v.\r\n";
+   std::cout << "-r Keeps one access log record out of every RATE. Default is 1, every request is logged.\r\n";
+   std::cout << "-m Serves latency percentiles and counters for Prometheus at this URI.\r\n";
    std::cout << "-d Specifies the directory that the server will use to read/write requested files. Default is the current directory when launching the application.\r\n";
    std::cout << "-i Specifies the path to the favorite icon saved in a PNG format." << std::endl;
 }
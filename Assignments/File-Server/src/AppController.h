@@ -27,6 +27,8 @@ SOFTWARE.
 #pragma once
 
 #include "CliParser.h"
+#include "HttpServer.h"
+#include "AccessLog.h"
 
 class AppController
 {
@@ -41,9 +43,13 @@ private:
    CommandLineParser m_CliParser;
 
    bool         m_Verbose;
+   bool         m_StaticRoutes;
    unsigned short m_Port;
+   HttpServer::Placement m_Placement;
+   Http::AccessLog::Options m_AccessLog;
    std::string  m_FileExplorerRoot;
    std::string  m_FaviconPath;
+   std::string  m_MetricsUri;
 
    static void printGeneralUsage();
 };
@@ -0,0 +1,198 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Chris McArthur, prince.chrismc(at)gmail(dot)com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+//
+// A fixed size slab of connections that the accept, cleanup and connection threads share without a lock. Entries are
+// reached through handles tagged with the generation of their slot, so a handle to a connection that has since been
+// removed never reaches whoever reused the slot.
+//
+// Each entry is pinned by its owner from Insert until Remove, anyone else has to Pin it before looking inside. The
+// entry is destroyed by whichever thread drops the last pin after it was removed. Free slots sit on a lock-free stack.
+//
+template<typename T>
+class ConnectionTable
+{
+public:
+   struct Handle
+   {
+      uint32_t m_uIndex;
+      uint32_t m_uGeneration;
+   };
+
+   explicit ConnectionTable( uint32_t capacity )
+      : m_pSlots( std::make_unique<Slot[]>( capacity ) ),
+      m_uCapacity( capacity ),
+      m_uFreeHead( pack( 0, capacity > 0 ? 0 : NO_SLOT ) )
+   {
+      for( uint32_t uIndex = 0; uIndex < capacity; uIndex += 1 )
+         m_pSlots[ uIndex ].m_uNextFree.store( uIndex + 1 < capacity ? uIndex + 1 : NO_SLOT, std::memory_order_relaxed );
+   }
+
+   ConnectionTable( const ConnectionTable& ) = delete;
+   ConnectionTable& operator=( const ConnectionTable& ) = delete;
+
+   // Nothing is constructed when the table is full, the arguments are left untouched for the caller to deal with
+   template<typename... Args>
+   std::optional<Handle> Insert( Args&&... args )
+   {
+      const uint32_t uIndex = popFree();
+      if( uIndex == NO_SLOT ) return std::nullopt;
+
+      Slot& oSlot = m_pSlots[ uIndex ];
+      oSlot.m_oValue.emplace( std::forward<Args>( args )... );
+
+      const uint32_t uGeneration = generation( oSlot.m_uState.load( std::memory_order_relaxed ) ) + 1; // odd while live
+      oSlot.m_uState.store( pack( uGeneration, 1 ), std::memory_order_release );
+
+      raiseTo( m_uSlotsInUse, uIndex + 1 );
+      raiseTo( m_nPeak, m_nLive.fetch_add( 1, std::memory_order_relaxed ) + 1 );
+
+      return Handle{ uIndex, uGeneration };
+   }
+
+   // Only the owner may use this, the pin taken by Insert keeps the entry alive
+   T& Get( Handle handle ) { return *m_pSlots[ handle.m_uIndex ].m_oValue; }
+
+   // Drops the owner's pin, the entry goes away as soon as nobody else has it pinned either
+   void Remove( Handle handle )
+   {
+      Slot& oSlot = m_pSlots[ handle.m_uIndex ];
+
+      uint64_t uState = oSlot.m_uState.load( std::memory_order_relaxed );
+      do
+      {
+         if( generation( uState ) != handle.m_uGeneration ) return; // already removed
+      } while( !oSlot.m_uState.compare_exchange_weak( uState, pack( handle.m_uGeneration + 1, pins( uState ) ), std::memory_order_acq_rel ) );
+
+      m_nLive.fetch_sub( 1, std::memory_order_relaxed );
+      unpin( handle.m_uIndex );
+   }
+
+   // Calls visit( Handle, T& ) for every live entry, entries inserted or removed meanwhile may or may not be seen
+   template<typename Visitor>
+   void ForEach( Visitor visit )
+   {
+      const uint32_t uInUse = m_uSlotsInUse.load( std::memory_order_acquire );
+      for( uint32_t uIndex = 0; uIndex < uInUse; uIndex += 1 )
+      {
+         const uint32_t uGeneration = generation( m_pSlots[ uIndex ].m_uState.load( std::memory_order_relaxed ) );
+         if( ( uGeneration & 1 ) == 0 || !pin( uIndex, uGeneration ) ) continue;
+
+         visit( Handle{ uIndex, uGeneration }, *m_pSlots[ uIndex ].m_oValue );
+         unpin( uIndex );
+      }
+   }
+
+   size_t Size() const { return m_nLive.load( std::memory_order_relaxed ); }
+   size_t Peak() const { return m_nPeak.load( std::memory_order_relaxed ); }
+   size_t Capacity() const { return m_uCapacity; }
+
+private:
+   static constexpr uint32_t NO_SLOT = UINT32_MAX;
+
+   struct Slot
+   {
+      std::atomic<uint64_t> m_uState{ 0 }; // generation in the upper half, pins in the lower
+      std::atomic<uint32_t> m_uNextFree{ NO_SLOT };
+      std::optional<T> m_oValue;
+   };
+
+   std::unique_ptr<Slot[]> m_pSlots;
+   const uint32_t m_uCapacity;
+
+   std::atomic<uint64_t> m_uFreeHead; // a tag in the upper half against ABA, the slot index in the lower
+   std::atomic<uint32_t> m_uSlotsInUse{ 0 }; // how far ForEach has to look
+   std::atomic<size_t> m_nLive{ 0 };
+   std::atomic<size_t> m_nPeak{ 0 };
+
+   static constexpr uint64_t pack( uint32_t high, uint32_t low ) { return ( static_cast<uint64_t>( high ) << 32 ) | low; }
+   static constexpr uint32_t upper( uint64_t word ) { return static_cast<uint32_t>( word >> 32 ); }
+   static constexpr uint32_t lower( uint64_t word ) { return static_cast<uint32_t>( word ); }
+   static constexpr uint32_t generation( uint64_t state ) { return upper( state ); }
+   static constexpr uint32_t pins( uint64_t state ) { return lower( state ); }
+
+   template<typename Counter>
+   static void raiseTo( std::atomic<Counter>& counter, Counter value )
+   {
+      Counter current = counter.load( std::memory_order_relaxed );
+      while( current < value && !counter.compare_exchange_weak( current, value, std::memory_order_release, std::memory_order_relaxed ) );
+   }
+
+   bool pin( uint32_t index, uint32_t expected_generation )
+   {
+      std::atomic<uint64_t>& uState = m_pSlots[ index ].m_uState;
+      uint64_t uCurrent = uState.load( std::memory_order_relaxed );
+      do
+      {
+         if( generation( uCurrent ) != expected_generation ) return false;
+      } while( !uState.compare_exchange_weak( uCurrent, uCurrent + 1, std::memory_order_acquire, std::memory_order_relaxed ) );
+
+      return true;
+   }
+
+   void unpin( uint32_t index )
+   {
+      Slot& oSlot = m_pSlots[ index ];
+      const uint64_t uPrevious = oSlot.m_uState.fetch_sub( 1, std::memory_order_acq_rel );
+
+      // A live entry always keeps its owner's pin, reaching zero means it was removed and this was the last look
+      if( pins( uPrevious ) == 1 && ( generation( uPrevious ) & 1 ) == 0 )
+      {
+         oSlot.m_oValue.reset();
+         pushFree( index );
+      }
+   }
+
+   uint32_t popFree()
+   {
+      uint64_t uHead = m_uFreeHead.load( std::memory_order_acquire );
+      uint32_t uIndex;
+      do
+      {
+         uIndex = lower( uHead );
+         if( uIndex == NO_SLOT ) return NO_SLOT;
+      } while( !m_uFreeHead.compare_exchange_weak( uHead, pack( upper( uHead ) + 1, m_pSlots[ uIndex ].m_uNextFree.load( std::memory_order_relaxed ) ),
+                                                   std::memory_order_acquire ) );
+
+      return uIndex;
+   }
+
+   void pushFree( uint32_t index )
+   {
+      uint64_t uHead = m_uFreeHead.load( std::memory_order_relaxed );
+      do
+      {
+         m_pSlots[ index ].m_uNextFree.store( lower( uHead ), std::memory_order_relaxed );
+      } while( !m_uFreeHead.compare_exchange_weak( uHead, pack( upper( uHead ) + 1, index ), std::memory_order_release, std::memory_order_relaxed ) );
+   }
+};
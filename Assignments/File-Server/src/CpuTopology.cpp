@@ -0,0 +1,191 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Chris McArthur, prince.chrismc(at)gmail(dot)com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "CpuTopology.h"
+#include <algorithm>
+#include <bitset>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <thread>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <filesystem>
+#endif
+
+static bool isAllowed( const CpuTopology::CpuSet& allowed, unsigned cpu )
+{
+   return std::find( allowed.begin(), allowed.end(), cpu ) != allowed.end();
+}
+
+#ifdef __linux__
+static_assert( CpuTopology::MAX_CPUS <= CPU_SETSIZE, "Every CPU that can be parsed must fit in a cpu_set_t" );
+
+static CpuTopology::CpuSet allowedCpus()
+{
+   cpu_set_t oMask;
+   CPU_ZERO( &oMask );
+   if( sched_getaffinity( 0, sizeof( oMask ), &oMask ) != 0 ) return {};
+
+   CpuTopology::CpuSet vecCpus;
+   for( unsigned uCpu = 0; uCpu < CPU_SETSIZE; uCpu += 1 )
+      if( CPU_ISSET( uCpu, &oMask ) ) vecCpus.push_back( uCpu );
+
+   return vecCpus;
+}
+
+static std::vector<CpuTopology::CpuSet> readNodes()
+{
+   std::map<unsigned long, CpuTopology::CpuSet> mapNodes; // ordered by node number, the directory is not
+
+   std::error_code ec;
+   for( const auto& oEntry : std::filesystem::directory_iterator( "/sys/devices/system/node", ec ) )
+   {
+      const std::string sName = oEntry.path().filename().string();
+      if( sName.size() <= 4 || sName.compare( 0, 4, "node" ) != 0 || sName.find_first_not_of( "0123456789", 4 ) != std::string::npos ) continue;
+
+      std::ifstream oCpuList( oEntry.path() / "cpulist" );
+      std::string sCpuList;
+      if( std::getline( oCpuList, sCpuList ) )
+         mapNodes[ std::stoul( sName.substr( 4 ) ) ] = CpuTopology::ParseCpuList( sCpuList );
+   }
+
+   std::vector<CpuTopology::CpuSet> vecNodes;
+   for( auto& oNode : mapNodes ) vecNodes.push_back( std::move( oNode.second ) );
+
+   return vecNodes;
+}
+#endif
+
+CpuTopology CpuTopology::Discover()
+{
+   CpuTopology oTopology;
+
+#ifdef __linux__
+   oTopology.m_vecNodes = readNodes();
+
+   const CpuSet vecAllowed = allowedCpus();
+   if( !vecAllowed.empty() )
+   {
+      oTopology = oTopology.Restrict( vecAllowed );
+      if( oTopology.m_vecNodes.empty() ) oTopology.m_vecNodes.push_back( vecAllowed ); // no NUMA support in the kernel
+   }
+#endif
+
+   if( oTopology.m_vecNodes.empty() )
+   {
+      CpuSet vecCpus( std::max( std::thread::hardware_concurrency(), 1u ) );
+      for( unsigned uCpu = 0; uCpu < vecCpus.size(); uCpu += 1 ) vecCpus[ uCpu ] = uCpu;
+
+      oTopology.m_vecNodes.push_back( std::move( vecCpus ) );
+   }
+
+   return oTopology;
+}
+
+CpuTopology CpuTopology::Restrict( const CpuSet& allowed ) const
+{
+   CpuTopology oRestricted;
+   for( const CpuSet& vecNode : m_vecNodes )
+   {
+      CpuSet vecKept;
+      std::copy_if( vecNode.begin(), vecNode.end(), std::back_inserter( vecKept ), [ &allowed ]( unsigned cpu ) { return isAllowed( allowed, cpu ); } );
+
+      if( !vecKept.empty() ) oRestricted.m_vecNodes.push_back( std::move( vecKept ) );
+   }
+
+   return oRestricted;
+}
+
+size_t CpuTopology::GetCpuCount() const
+{
+   size_t nCount = 0;
+   for( const CpuSet& vecNode : m_vecNodes ) nCount += vecNode.size();
+
+   return nCount;
+}
+
+CpuTopology::CpuSet CpuTopology::ParseCpuList( std::string_view list )
+{
+   CpuSet vecCpus;
+   std::bitset<MAX_CPUS> oSeen;
+
+   while( !list.empty() )
+   {
+      const size_t ulComma = list.find( ',' );
+      const std::string sRange( list.substr( 0, ulComma ) );
+      list = ( ulComma == std::string_view::npos ) ? std::string_view() : list.substr( ulComma + 1 );
+
+      if( sRange.find_first_not_of( " \t\r\n" ) == std::string::npos ) continue;
+
+      try
+      {
+         size_t ulEnd = 0;
+         const unsigned long ulFirst = std::stoul( sRange, &ulEnd );
+         unsigned long ulLast = ulFirst;
+
+         if( ulEnd < sRange.size() && sRange[ ulEnd ] == '-' )
+            ulLast = std::stoul( sRange.substr( ulEnd + 1 ) );
+
+         // Checked before the loop, a typo must not keep it going for billions of CPUs
+         if( ulLast < ulFirst || ulLast >= MAX_CPUS ) return {};
+
+         for( unsigned uCpu = static_cast<unsigned>( ulFirst ); uCpu <= ulLast; uCpu += 1 )
+         {
+            if( oSeen.test( uCpu ) ) continue;
+
+            oSeen.set( uCpu );
+            vecCpus.push_back( uCpu );
+         }
+      }
+      catch( const std::exception& )
+      {
+         return {};
+      }
+   }
+
+   return vecCpus;
+}
+
+bool CpuTopology::PinCurrentThread( const CpuSet& cpus )
+{
+#ifdef __linux__
+   if( cpus.empty() ) return false;
+
+   cpu_set_t oMask;
+   CPU_ZERO( &oMask );
+   for( unsigned uCpu : cpus )
+      if( uCpu < CPU_SETSIZE ) CPU_SET( uCpu, &oMask );
+
+   return pthread_setaffinity_np( pthread_self(), sizeof( oMask ), &oMask ) == 0;
+#else
+   ( void )cpus;
+   return false;
+#endif
+}
@@ -0,0 +1,61 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Chris McArthur, prince.chrismc(at)gmail(dot)com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#pragma once
+
+#include <string_view>
+#include <vector>
+
+//
+// The CPUs this process may run on, grouped by the NUMA node they belong to. Memory a thread touches first is placed
+// on its node, so threads kept within a node keep the memory they work on local.
+//
+class CpuTopology
+{
+public:
+   using CpuSet = std::vector<unsigned>;
+
+   // Reads the layout from sysfs, anywhere else every CPU is assumed to share a single node
+   static CpuTopology Discover();
+
+   // Keeps only the CPUs listed, nodes left empty are dropped
+   CpuTopology Restrict( const CpuSet& allowed ) const;
+
+   const std::vector<CpuSet>& GetNodes() const { return m_vecNodes; }
+   size_t GetCpuCount() const;
+
+   // The kernel's list format, for instance "0-3,8,10-11", an empty set when it makes no sense or names a CPU at or
+   // above MAX_CPUS. Each CPU is listed once, in the order it first appears.
+   static CpuSet ParseCpuList( std::string_view list );
+
+   static constexpr unsigned MAX_CPUS = 1024; // as many as a cpu_set_t holds
+
+   // Only the calling thread and those it starts afterwards are affected, false when the platform can't do it
+   static bool PinCurrentThread( const CpuSet& cpus );
+
+private:
+   std::vector<CpuSet> m_vecNodes;
+};
@@ -25,12 +25,77 @@ SOFTWARE.
 */
 
 #include "FileServlet.h"
+#include "Url.h"
+#include <cstdint>
 #include <exception>
 #include <fstream>
 #include <sstream>
+#include <thread>
 
 using Http::Version;
 using Http::Status;
+using Http::ContentCoding::Coding;
+
+// Compressed copies of the files served live here, under the same relative path, so each is only compressed once
+static const std::filesystem::path CACHE_DIRECTORY = ".httpfs-cache";
+
+// Heads every cached copy, it is only used while the file still has the very same write time and size
+struct CacheStamp
+{
+   int64_t m_lWriteTime;
+   uint64_t m_ulSize;
+
+   bool operator==( const CacheStamp& other ) const { return m_lWriteTime == other.m_lWriteTime && m_ulSize == other.m_ulSize; }
+};
+
+// Below this the headers cost more than compressing saves
+static constexpr std::uintmax_t MIN_COMPRESSED_SIZE = 256;
+
+static bool isCompressible( Http::ContentType content_type )
+{
+   switch( content_type )
+   {
+   case Http::ContentType::Text:
+   case Http::ContentType::Html:
+   case Http::ContentType::Json:
+   case Http::ContentType::Yaml:
+   case Http::ContentType::Xml:
+      return true;
+   default:
+      return false;
+   }
+}
+
+// The cache is the server's own business, it is never listed nor served as it is
+static bool isCachePath( std::string_view path )
+{
+   const std::string_view sFirst = path.substr( 1, path.find( '/', 1 ) - 1 );
+   return sFirst == CACHE_DIRECTORY.string();
+}
+
+// The path a request names with its escapes decoded, nothing when its target is malformed
+static std::optional<std::string> decodedPathOf( const HttpRequest& request )
+{
+   const std::optional<Http::Url> oTarget = Http::Url::ParseRequestTarget( request.GetUri() );
+   if( !oTarget.has_value() ) return std::nullopt;
+
+   std::string sPath;
+   if( !Http::PercentDecode( oTarget->m_sPath, sPath ) || sPath.find( '\0' ) != std::string::npos ) return std::nullopt;
+
+   if( sPath.empty() || sPath.front() != '/' ) sPath.insert( sPath.begin(), '/' );
+   return sPath;
+}
+
+// Whether a decoded path could name something outside the root. Besides "..", a "//" or a backslash would make what
+// follows a path of its own once joined to the root, checking the joined path catches whatever else a platform makes of it.
+static bool leavesRoot( const std::filesystem::path& root, std::string_view path )
+{
+   if( path.find( "/.." ) != std::string_view::npos || path.find( "//" ) != std::string_view::npos || path.find( '\\' ) != std::string_view::npos )
+      return true;
+
+   const std::filesystem::path oRelative = ( root / path.substr( 1 ) ).lexically_normal().lexically_relative( root.lexically_normal() );
+   return oRelative.empty() || *oRelative.begin() == "..";
+}
 
 FileServlet::FileServlet( const std::string& path ) : m_Path( path )
 {
@@ -54,10 +119,15 @@ HttpResponse FileServlet::HandleRequest( const HttpRequest& request ) const noex
 
 HttpResponse FileServlet::HandleGetRequest( const HttpRequest& request ) const noexcept
 {
-   if( request.GetUri().find( "/.." ) != std::string::npos )
+   const std::optional<std::string> sPath = decodedPathOf( request );
+   if( !sPath.has_value() )
+      return{ Http::Version::v10, Status::BadRequest, "MALFORMED REQUEST TARGET" };
+
+   // Checked once decoded, "%2e%2e" is just as much a way up
+   if( leavesRoot( m_Path, *sPath ) || isCachePath( *sPath ) )
       return{ Http::Version::v10, Status::Forbidden, "NICE TRY ACCESSING FORBIDDEN DIRECTORY OF FILE SYSTEM" };
 
-   const std::filesystem::path oRequested = m_Path / request.GetUri().substr( 1 );
+   const std::filesystem::path oRequested = m_Path / sPath->substr( 1 );
 
    if( !std::filesystem::exists( oRequested ) )
       return{ Http::Version::v10, Status::NotFound, "NOT FOUND" };
@@ -66,7 +136,7 @@ HttpResponse FileServlet::HandleGetRequest( const HttpRequest& request ) const n
       return HandleDirectoryRequest( oRequested );
 
    if( std::filesystem::is_regular_file( oRequested ) )
-      return HandleFileRequest( oRequested );
+      return HandleFileRequest( oRequested, Http::ContentCoding::Negotiate( request.GetMessageHeader( "Accept-Encoding" ) ) );
 
    return{ Http::Version::v10, Status::NotImplemented, "ONLY SUPPORTS DIRS AND FILES" };
 }
@@ -81,6 +151,9 @@ HttpResponse FileServlet::HandleDirectoryRequest( const std::filesystem::path& r
 
    for( auto& oEntry : std::filesystem::directory_iterator( requested ) )
    {
+      if( oEntry.path().filename() == CACHE_DIRECTORY )
+         continue;
+
       if( oEntry.is_directory() )
          oResponse.AppendMessageBody( "   - " + oEntry.path().filename().string() + "/\r\n" );
       else if( oEntry.is_regular_file() )
@@ -90,26 +163,100 @@ HttpResponse FileServlet::HandleDirectoryRequest( const std::filesystem::path& r
    return oResponse;
 }
 
-HttpResponse FileServlet::HandleFileRequest( const std::filesystem::path& requested ) const noexcept
+HttpResponse FileServlet::HandleFileRequest( const std::filesystem::path& requested, Coding coding ) const noexcept
 {
    HttpResponse oResponse( Http::Version::v10, Status::Ok, "OK" );
    oResponse.SetContentType( FileExtensionToContentType( requested ) );
    oResponse.SetMessageHeader( "Content-Disposition", "inline" );
 
-   if( oResponse.GetContentType() != Http::ContentType::Png )
-      oResponse.AppendMessageBody( "File: " + std::filesystem::canonical( requested ).string() + "\r\n" );
+   std::error_code oError;
+   const bool bCompress = isCompressible( oResponse.GetContentType() ) &&
+                          std::filesystem::file_size( requested, oError ) >= MIN_COMPRESSED_SIZE;
+   if( isCompressible( oResponse.GetContentType() ) )
+      oResponse.SetMessageHeader( "Vary", "Accept-Encoding" );
+
+   try
+   {
+      if( bCompress && coding != Coding::Identity )
+      {
+         oResponse.AppendMessageBody( LoadCompressedFileBody( requested, oResponse.GetContentType(), coding ) );
+         oResponse.SetMessageHeader( "Content-Encoding", Http::ContentCoding::ToString( coding ) );
+      }
+      else
+         oResponse.AppendMessageBody( LoadFileBody( requested, oResponse.GetContentType() ) );
+   }
+   catch( const std::exception& )
+   {
+      return{ Http::Version::v10, Status::InternalServerError, "COULD NOT LOAD FILE" };
+   }
+
+   return oResponse;
+}
+
+std::string FileServlet::LoadFileBody( const std::filesystem::path& requested, Http::ContentType content_type ) const
+{
+   std::string sBody;
+   if( content_type != Http::ContentType::Png )
+      sBody = "File: " + std::filesystem::canonical( requested ).string() + "\r\n";
 
    std::ifstream fileReader( requested.string(), std::ios::in | std::ios::binary | std::ios::ate );
-   if( !fileReader ) return{ Http::Version::v10, Status::InternalServerError, "COULD NOT LOAD FILE" };
+   if( !fileReader ) throw std::runtime_error( "Could not load file" );
 
    const size_t size = fileReader.tellg();
-   std::string fileBuffer( size, '\0' ); // construct buffer
+   const size_t offset = sBody.size();
+   sBody.resize( offset + size, '\0' ); // construct buffer
    fileReader.seekg( 0 ); // rewind
-   fileReader.read( fileBuffer.data(), size );
+   fileReader.read( sBody.data() + offset, size );
 
-   oResponse.AppendMessageBody( fileBuffer );
+   return sBody;
+}
 
-   return oResponse;
+std::string FileServlet::LoadCompressedFileBody( const std::filesystem::path& requested, Http::ContentType content_type,
+                                                 Coding coding ) const
+{
+   std::filesystem::path oCached = m_Path / CACHE_DIRECTORY / requested.lexically_relative( m_Path );
+   oCached += ( coding == Coding::Gzip ) ? ".gz" : ".zz";
+
+   // Taken before the file is read, a write that lands while it is being compressed leaves a stamp that no longer matches.
+   // The cache's own times say nothing, a copy renamed into place late or a coarse clock would make a stale one look new.
+   std::error_code oTimeError;
+   std::error_code oSizeError;
+   const CacheStamp oStamp{ static_cast<int64_t>( std::filesystem::last_write_time( requested, oTimeError ).time_since_epoch().count() ),
+                            static_cast<uint64_t>( std::filesystem::file_size( requested, oSizeError ) ) };
+   const bool bStamped = !oTimeError && !oSizeError;
+
+   // Any problem with the cache just means compressing again
+   std::ifstream cacheReader( oCached.string(), std::ios::in | std::ios::binary | std::ios::ate );
+   const size_t ulCached = cacheReader ? static_cast<size_t>( cacheReader.tellg() ) : 0;
+   CacheStamp oCachedStamp{};
+   if( bStamped && ulCached >= sizeof( CacheStamp ) && cacheReader.seekg( 0 ) &&
+       cacheReader.read( reinterpret_cast<char*>( &oCachedStamp ), sizeof( CacheStamp ) ) && oCachedStamp == oStamp )
+   {
+      std::string sCompressed( ulCached - sizeof( CacheStamp ), '\0' );
+      if( cacheReader.read( sCompressed.data(), sCompressed.size() ) ) return sCompressed;
+   }
+   cacheReader.close();
+
+   std::string sCompressed = Http::ContentCoding::Compress( LoadFileBody( requested, content_type ), coding );
+   if( !bStamped ) return sCompressed; // nothing to tell a stale copy by
+
+   std::error_code oError;
+
+   // Written aside and renamed, so a concurrent request never reads half of it
+   std::filesystem::path oTemporary = oCached;
+   oTemporary += ".tmp" + std::to_string( std::hash<std::thread::id>{}( std::this_thread::get_id() ) );
+   std::filesystem::create_directories( oCached.parent_path(), oError );
+   {
+      std::ofstream cacheWriter( oTemporary.string(), std::ios::out | std::ios::binary | std::ios::trunc );
+      cacheWriter.write( reinterpret_cast<const char*>( &oStamp ), sizeof( CacheStamp ) );
+      cacheWriter.write( sCompressed.data(), sCompressed.size() );
+      if( !cacheWriter ) oError = std::make_error_code( std::errc::io_error );
+   }
+
+   if( !oError ) std::filesystem::rename( oTemporary, oCached, oError );
+   if( oError ) std::filesystem::remove( oTemporary, oError );
+
+   return sCompressed;
 }
 
 Http::ContentType FileServlet::FileExtensionToContentType( const std::filesystem::path& requested ) const noexcept
@@ -141,10 +288,15 @@ Http::ContentType FileServlet::FileExtensionToContentType( const std::filesystem
 
 HttpResponse FileServlet::HandlePostRequest( const HttpRequest& request ) const noexcept
 {
-   if( request.GetUri().find( "/.." ) != std::string::npos )
+   const std::optional<std::string> sPath = decodedPathOf( request );
+   if( !sPath.has_value() )
+      return{ Http::Version::v10, Status::BadRequest, "MALFORMED REQUEST TARGET" };
+
+   // Checked once decoded, "%2e%2e" is just as much a way up
+   if( leavesRoot( m_Path, *sPath ) || isCachePath( *sPath ) )
       return{ Http::Version::v10, Status::Forbidden, "NICE TRY ACCESSING FORBIDDEN DIRECTORY OF FILE SYSTEM" };
 
-   const std::filesystem::path oRequested = std::filesystem::absolute( m_Path / request.GetUri().substr( 1 ) );
+   const std::filesystem::path oRequested = std::filesystem::absolute( m_Path / sPath->substr( 1 ) );
 
    if( !std::filesystem::exists( oRequested ) )
       return HandleCreateItemRequest( oRequested, request.GetBody() );
@@ -159,7 +311,7 @@ HttpResponse FileServlet::HandlePostRequest( const HttpRequest& request ) const
 }
 
 HttpResponse FileServlet::HandleCreateItemRequest( const std::filesystem::path& requested,
-                                                   const std::string& content ) const noexcept
+                                                   std::string_view content ) const noexcept
 {
    if( requested.has_extension() || content.length() )
       return HandleCreateFileRequest( requested, content );
@@ -177,7 +329,7 @@ void CreateParentDirectories( const std::filesystem::path& requested )
 }
 
 HttpResponse FileServlet::HandleCreateFileRequest( const std::filesystem::path& requested,
-                                                   const std::string& content ) const noexcept
+                                                   std::string_view content ) const noexcept
 {
    HttpResponse oResponse( Http::Version::v10, Status::Conflict, "FAILED TO CREATE FILE" );
    try
@@ -200,7 +352,8 @@ HttpResponse FileServlet::HandleCreateFileRequest( const std::filesystem::path&
       if( oResponse.GetContentType() != Http::ContentType::Png )
          oResponse.AppendMessageBody( "File: " + std::filesystem::canonical( requested ).string() + "\r\n" );
 
-      oResponse.AppendMessageBody( content + "\r\n" );
+      oResponse.AppendMessageBody( content );
+      oResponse.AppendMessageBody( "\r\n" );
    }
    catch( const std::exception& e )
    {
@@ -230,7 +383,7 @@ HttpResponse FileServlet::HandleCreateDirectoryRequest( const std::filesystem::p
 }
 
 HttpResponse FileServlet::HandleWriteFileRequest( const std::filesystem::path& requested,
-                                                  const std::string& content ) const noexcept
+                                                  std::string_view content ) const noexcept
 {
    auto lasWrite = std::chrono::time_point_cast<std::chrono::seconds>(
       std::filesystem::last_write_time( requested )
@@ -27,7 +27,9 @@ SOFTWARE.
 #pragma once
 
 #include "HttpServer.h"
+#include "ContentCoding.h"
 #include <filesystem>
+#include <optional>
 
 class FileServlet : public HttpServlet
 {
@@ -39,17 +41,20 @@ public:
 private:
    HttpResponse HandleGetRequest( const HttpRequest& request ) const noexcept;
    HttpResponse HandleDirectoryRequest( const std::filesystem::path& requested ) const noexcept;
-   HttpResponse HandleFileRequest( const std::filesystem::path& requested ) const noexcept;
+   HttpResponse HandleFileRequest( const std::filesystem::path& requested, Http::ContentCoding::Coding coding ) const noexcept;
+   std::string LoadFileBody( const std::filesystem::path& requested, Http::ContentType content_type ) const;
+   std::string LoadCompressedFileBody( const std::filesystem::path& requested, Http::ContentType content_type,
+                                       Http::ContentCoding::Coding coding ) const;
    Http::ContentType FileExtensionToContentType( const std::filesystem::path& requested ) const noexcept;
 
    HttpResponse HandlePostRequest( const HttpRequest& request ) const noexcept;
    HttpResponse HandleCreateItemRequest( const std::filesystem::path& requested,
-                                         const std::string& content ) const noexcept;
+                                         std::string_view content ) const noexcept;
    HttpResponse HandleCreateFileRequest( const std::filesystem::path& requested,
-                                         const std::string& content ) const noexcept;
+                                         std::string_view content ) const noexcept;
    HttpResponse HandleCreateDirectoryRequest( const std::filesystem::path& requested ) const noexcept;
    HttpResponse HandleWriteFileRequest( const std::filesystem::path& requested,
-                                        const std::string& content ) const noexcept;
+                                        std::string_view content ) const noexcept;
 
    const std::filesystem::path m_Path;
 };
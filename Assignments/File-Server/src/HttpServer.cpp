@@ -25,233 +25,462 @@ SOFTWARE.
 */
 
 #include "HttpServer.h"
-#include <iterator>
-#include <sstream>
-#include <algorithm>
-#include <iostream>
+#include "AccessLog.h"
+#include <thread>
+#include <utility>
 
 using namespace std::chrono_literals;
 
+namespace
+{
+   class MetricsServlet : public HttpServlet
+   {
+   public:
+      explicit MetricsServlet( const HttpServer& server ) : m_oServer( server ) {}
+
+      HttpResponse HandleRequest( const HttpRequest& /*request*/ ) const noexcept override
+      {
+         HttpResponse oResponse( Http::Version::v11, Http::Status::Ok, "OK", Http::ContentType::Text, {} );
+         oResponse.AppendMessageBody( m_oServer.GetMetrics().ToPrometheus() );
+         return oResponse;
+      }
+
+   private:
+      const HttpServer& m_oServer;
+   };
+}
+
+// Lets several listeners bind the same port, the kernel then spreads new connections across them
+static bool enableReusePort( CPassiveSocket& socket )
+{
+#ifdef SO_REUSEPORT
+   int nEnable = 1;
+   return setsockopt( socket.GetSocketDescriptor(), SOL_SOCKET, SO_REUSEPORT, &nEnable, sizeof( nEnable ) ) == 0;
+#else
+   ( void )socket;
+   return false;
+#endif
+}
+
 HttpServer::HttpServer( Http::Version version /*= v11*/ )
    : m_eVersion( version )
    , m_pExitEvent( std::make_unique<std::promise<void>>() )
 {
 }
 
+HttpServer::~HttpServer()
+{
+   Close();
+}
+
 bool HttpServer::RegisterServlet( const char * uri, HttpServlet * servlet )
 {
    if( uri == nullptr || uri[ 0 ] != '/' ) return false;
 
-   return m_RestfulServlets.try_emplace( uri, servlet ).second;
+   return m_Router.Register( uri, servlet );
+}
+
+bool HttpServer::ServeMetrics( const char* uri )
+{
+   if( m_pMetricsServlet == nullptr ) m_pMetricsServlet = std::make_unique<MetricsServlet>( *this );
+
+   return RegisterServlet( uri, m_pMetricsServlet.get() );
 }
 
 void HttpServer::Launch( unsigned short port )
 {
-   if( !m_oSocket.Listen( nullptr, port ) )
-      throw std::runtime_error( "Unable to bind HTTP Server" );
+   Launch( port, Placement() );
+}
+
+void HttpServer::Launch( unsigned short port, const Placement& placement )
+{
+   unsigned uAcceptors = placement.m_uAcceptors;
+#ifndef SO_REUSEPORT
+   uAcceptors = 1; // listeners can not share a port here, a single one takes everything
+#endif
+
+   if( uAcceptors == 0 ) throw std::invalid_argument( "At least one acceptor is required!" );
+   if( placement.m_uConnectionsPerAcceptor == 0 ) throw std::invalid_argument( "Acceptors must be allowed some connections!" );
+
+   std::function<void( Connections&, ConnectionHandle )> HandleNewConnection;
+
+   switch( m_eVersion )
+   {
+   case Http::Version::v10:
+      HandleNewConnection = [ this ]( Connections& connections, ConnectionHandle hClient )
+      {
+         NonPersistentConnection( &connections.Get( hClient ) );
+         connections.Remove( hClient );
+      };
+      break;
+   case Http::Version::v11:
+      HandleNewConnection = [ this ]( Connections& connections, ConnectionHandle hClient )
+      {
+         PersistentConnection( &connections.Get( hClient ) );
+         connections.Remove( hClient );
+      };
+      break;
+   default:
+      throw std::invalid_argument( "Bad HTTP version!" );
+   }
+
+   // Acceptors go round the nodes first then the CPUs within them, so a few acceptors already cover every node
+   const bool bPinned = uAcceptors > 1 || !placement.m_vecCpus.empty();
+   CpuTopology oTopology = CpuTopology::Discover();
+   if( !placement.m_vecCpus.empty() ) oTopology = oTopology.Restrict( placement.m_vecCpus );
+   if( bPinned && oTopology.GetNodes().empty() ) throw std::invalid_argument( "None of the CPUs given are available!" );
+
+   CpuTopology::CpuSet vecEveryCpu;
+   for( const auto& vecNode : oTopology.GetNodes() ) vecEveryCpu.insert( vecEveryCpu.end(), vecNode.begin(), vecNode.end() );
+
+   // Only handed to the server once every listener is bound, a failure part way leaves nothing half started behind
+   std::vector<std::unique_ptr<Acceptor>> vecAcceptors;
+   for( unsigned uIndex = 0; uIndex < uAcceptors; uIndex += 1 )
+   {
+      auto pAcceptor = std::make_unique<Acceptor>();
+
+      if( bPinned )
+      {
+         const auto& vecNode = oTopology.GetNodes()[ uIndex % oTopology.GetNodes().size() ];
+         pAcceptor->m_vecAcceptorCpus = { vecNode[ ( uIndex / oTopology.GetNodes().size() ) % vecNode.size() ] };
+         pAcceptor->m_vecConnectionCpus = placement.m_bNodeLocal ? vecNode : vecEveryCpu;
+      }
+
+      if( uAcceptors > 1 && !enableReusePort( pAcceptor->m_oSocket ) )
+         throw std::runtime_error( "Unable to share the HTTP Server port" );
+
+      if( !pAcceptor->m_oSocket.Listen( nullptr, port ) )
+         throw std::runtime_error( "Unable to bind HTTP Server" );
+
+      pAcceptor->m_oSocket.SetBlocking();
+      vecAcceptors.push_back( std::move( pAcceptor ) );
+   }
+
+   m_vecAcceptors = std::move( vecAcceptors );
 
    auto oExitEvent = std::make_shared<std::shared_future<void>>( m_pExitEvent->get_future() );
 
-   std::thread( [ this, oExitEvent ]
-                {
-                   while( oExitEvent->wait_for( 10ms ) == std::future_status::timeout )
+   std::vector<std::future<void>> vecReady;
+   for( auto& pOwnedAcceptor : m_vecAcceptors )
+   {
+      std::promise<void> oReady;
+      vecReady.push_back( oReady.get_future() );
+
+      m_vecThreads.emplace_back( [ this, oExitEvent, HandleNewConnection, pAcceptor = pOwnedAcceptor.get(), uCapacity = placement.m_uConnectionsPerAcceptor, oReady = std::move( oReady ) ]() mutable
                    {
-                      std::unique_lock<std::mutex> cleanLock( m_muConnectionList );
-                      if( m_cvCleanSignal.wait_for( cleanLock, 20ms, [ this ] { return !m_vecClients.empty(); } ) )
+                      if( !pAcceptor->m_vecAcceptorCpus.empty() )
+                         CpuTopology::PinCurrentThread( pAcceptor->m_vecAcceptorCpus );
+
+                      pAcceptor->m_pConnections = std::make_unique<Connections>( uCapacity ); // first touched from here
+                      oReady.set_value();
+
+                      while( true )
                       {
-                         for( auto itor = m_vecClients.begin(); itor != m_vecClients.end(); /* no itor */ )
+                         std::shared_ptr<CActiveSocket> pClient = pAcceptor->m_oSocket.Accept(); // Wait for an incomming connection
+                         if( oExitEvent->wait_for( 0ms ) != std::future_status::timeout ) break; // Close woke us up
+
+                         if( pClient == nullptr )
                          {
-                            auto connection = itor->get();
-                            if( !ConnectionIsAlive( connection ) )
-                            {
-                               if( connection->m_pClient != nullptr )
-                                  connection->m_pClient->Shutdown( CSimpleSocket::Both );
-
-                               itor = m_vecClients.erase( itor );
-                            }
-                            else
-                            {
-                               ++itor;
-                            }
+                            std::this_thread::sleep_for( 1ms ); // out of descriptors or the like, back off rather than spin
+                            continue;
                          }
 
-                         m_vecClients.shrink_to_fit();
-                      }
-                   }
-                }
-   ).detach();
+                         Http::AccessLog::Write( "connect", "client=%p", static_cast<void*>( pClient.get() ) );
 
-   std::thread( [ this, oExitEvent ]
-                {
-                   std::function<void( std::shared_ptr<ClientConnection> )> HandleNewConnection;
+                         const auto hClient = pAcceptor->m_pConnections->Insert( std::move( pClient ) );
+                         if( !hClient.has_value() )
+                         {
+                            Http::AccessLog::Write( "refused", "client=%p capacity=%zu", static_cast<void*>( pClient.get() ), pAcceptor->m_pConnections->Capacity() );
+                            pClient->Close();
+                            continue;
+                         }
 
-                   switch( m_eVersion )
-                   {
-                   case Http::Version::v10:
-                      HandleNewConnection = [ this ]( std::shared_ptr<ClientConnection> pClient ) { NonPersistentConnection( pClient.get() ); };
-                      break;
-                   case Http::Version::v11:
-                      HandleNewConnection = [ this ]( std::shared_ptr<ClientConnection> pClient ) { PersistentConnection( pClient.get() ); };
-                      break;
-                   default:
-                      throw std::invalid_argument( "Bad HTTP version!" );
-                   }
+                         {
+                            std::lock_guard<std::mutex> oLock( m_muConnectionThreads );
+                            m_nConnectionThreads += 1;
+                         }
 
-                   while( oExitEvent->wait_for( 10ms ) == std::future_status::timeout )
-                   {
-                      std::shared_ptr<CActiveSocket> pClient;
-                      if( ( pClient = m_oSocket.Accept() ) != nullptr ) // Wait for an incomming connection
-                      {
-                         std::cout << "New client obtained { " << std::hex << pClient.get() << " }" << std::endl;
+                         std::thread( [ this, HandleNewConnection, pAcceptor, hClient = hClient.value() ]
+                                      {
+                                         if( !pAcceptor->m_vecConnectionCpus.empty() )
+                                            CpuTopology::PinCurrentThread( pAcceptor->m_vecConnectionCpus );
 
-                         std::lock_guard<std::mutex> oAutoLock( m_muConnectionList );
-                         m_vecClients.push_back( std::make_shared<ClientConnection>( std::move( pClient ) ) );
+                                         {
+                                            ServerMetrics::Scope oMetrics( m_Metrics ); // merged once the connection is over
+                                            HandleNewConnection( *pAcceptor->m_pConnections, hClient );
+                                         }
 
-                         std::thread( HandleNewConnection, m_vecClients.back() ).detach();
+                                         ConnectionThreadDone(); // the server may be gone past this point
+                                      }
+                         ).detach();
                       }
                    }
-                }
-   ).detach();
+      );
+   }
+
+   for( auto& oReady : vecReady ) oReady.wait();
+
+   m_vecThreads.emplace_back( [ this, oExitEvent ]
+                              {
+                                 // Wakes the connections that went quiet, each one takes itself out of the table once its thread is done
+                                 while( oExitEvent->wait_for( 30ms ) == std::future_status::timeout )
+                                 {
+                                    ForEachConnection( []( ClientConnection& connection )
+                                                       {
+                                                          if( connection.m_pClient != nullptr && !ConnectionIsAlive( &connection ) )
+                                                             connection.Shutdown();
+                                                       } );
+                                 }
+                              }
+   );
 }
 
-bool HttpServer::Close()
+bool HttpServer::Close( std::chrono::milliseconds drain_deadline /*= DEFAULT_DRAIN_DEADLINE*/ )
 {
-   bool bRetVal = m_oSocket.Shutdown( CSimpleSocket::Both );
+   if( m_bClosed || m_vecAcceptors.empty() ) return false;
+   m_bClosed = true;
 
-   if( bRetVal )
+   m_bDraining = true;
+   m_pExitEvent->set_value(); // before the sockets go so the acceptors know why they woke up
+
+   bool bRetVal = true;
+   for( auto& pAcceptor : m_vecAcceptors )
    {
-      bRetVal = m_oSocket.Close();
+      bRetVal = pAcceptor->m_oSocket.Shutdown( CSimpleSocket::Both ) && bRetVal;
+      bRetVal = pAcceptor->m_oSocket.Close() && bRetVal;
    }
 
-   m_pExitEvent->set_value();
+   for( auto& oThread : m_vecThreads ) oThread.join(); // no connection can be added after this
+   m_vecThreads.clear();
+
+   // Keep-alive connections between requests would otherwise wait for one that is never coming
+   ForEachConnection( []( ClientConnection& connection )
+                      {
+                         if( connection.m_bIdle ) connection.Shutdown();
+                      } );
+
+   std::unique_lock<std::mutex> oLock( m_muConnectionThreads );
+   if( !m_cvConnectionThreads.wait_for( oLock, drain_deadline, [ this ] { return m_nConnectionThreads == 0; } ) )
+   {
+      oLock.unlock();
+      ForEachConnection( []( ClientConnection& connection ) { connection.Shutdown(); } );
+      oLock.lock();
+
+      m_cvConnectionThreads.wait( oLock, [ this ] { return m_nConnectionThreads == 0; } );
+   }
 
    return bRetVal;
 }
 
+void HttpServer::ForEachConnection( const std::function<void( ClientConnection& )>& visit )
+{
+   for( auto& pAcceptor : m_vecAcceptors )
+      if( pAcceptor->m_pConnections != nullptr ) // its thread may never have started
+         pAcceptor->m_pConnections->ForEach( [ &visit ]( ConnectionHandle, ClientConnection& connection ) { visit( connection ); } );
+}
+
+void HttpServer::ConnectionThreadDone()
+{
+   std::lock_guard<std::mutex> oLock( m_muConnectionThreads );
+   m_nConnectionThreads -= 1;
+   m_cvConnectionThreads.notify_all();
+}
+
+size_t HttpServer::GetConnectionCount() const
+{
+   size_t nCount = 0;
+   for( const auto& pAcceptor : m_vecAcceptors )
+      if( pAcceptor->m_pConnections != nullptr ) nCount += pAcceptor->m_pConnections->Size();
+
+   return nCount;
+}
+
+ServerMetrics::Snapshot HttpServer::GetMetrics() const
+{
+   ServerMetrics::Snapshot oSnapshot = m_Metrics.Collect();
+   oSnapshot.m_nConnections = GetConnectionCount();
+   oSnapshot.m_nPeakConnections = GetPeakConnectionCount();
+
+   return oSnapshot;
+}
+
+size_t HttpServer::GetPeakConnectionCount() const
+{
+   size_t nPeak = 0;
+   for( const auto& pAcceptor : m_vecAcceptors )
+      if( pAcceptor->m_pConnections != nullptr ) nPeak += pAcceptor->m_pConnections->Peak();
+
+   return nPeak;
+}
+
 HttpServer::ClientConnection::ClientConnection( std::shared_ptr<CActiveSocket>&& client ) : m_pClient( client )
 {
 }
 
-HttpServlet* HttpServer::BestMatchingServlet( const std::string & uri ) const
+HttpServer::ClientConnection::~ClientConnection()
 {
-   for( auto itor = m_RestfulServlets.crbegin(); itor != m_RestfulServlets.crend(); ++itor )
-   {
-      if( uri.compare( 0, itor->first.length(), itor->first ) == 0 ) return itor->second;
-   }
+   m_pClient->Close(); // nobody has the entry pinned anymore
+}
+
+void HttpServer::ClientConnection::Shutdown()
+{
+   m_bOpen = false;
+   m_pClient->Shutdown( CSimpleSocket::Both );
+}
+
+HttpResponse HttpServer::Dispatch( const HttpRequest& oRequest ) const
+{
+   std::optional<HttpResponse> oResponse = DispatchRegistered( oRequest );
+   if( !oResponse.has_value() )
+      return HttpResponse( oRequest.GetVersion(), Http::Status::NotFound, "NOT FOUND" );
 
-   return nullptr;
+   return std::move( *oResponse );
+}
+
+std::optional<HttpResponse> HttpServer::DispatchRegistered( const HttpRequest& oRequest ) const
+{
+   ServerMetrics::PhaseTimer oRoute( ServerMetrics::Phase::Route );
+   const auto oMatch = m_Router.Find( oRequest.GetUri() );
+   oRoute.Stop();
+
+   if( oMatch.m_Servlet == nullptr )
+      return std::nullopt;
+
+   ServerMetrics::PhaseTimer oHandle( ServerMetrics::Phase::Handle );
+   return oMatch.m_Servlet->HandleRequest( oRequest, oMatch.m_Parameters );
 }
 
 bool HttpServer::ConnectionIsAlive( ClientConnection* pConnection )
 {
-   return std::chrono::steady_clock::now() - pConnection->m_tLastSighting <= 100s &&
-      pConnection->m_pClient->IsSocketValid() &&
+   return std::chrono::steady_clock::now() - pConnection->m_tLastSighting.load() <= 100s &&
+      pConnection->m_bOpen &&
       pConnection->m_nRemainingRequests > 0;
 
 }
 
 void HttpServer::NonPersistentConnection( ClientConnection* pConnection ) const
 {
-   auto pClient = pConnection->m_pClient.get();
-   auto oPotentialRequest = ReadNextRequest( pClient );
+   Http::Arena oArena;
+   Http::ArenaScope oScope( oArena );
+
+   std::string sPipelined; // nothing more is answered on this connection
+   auto oPotentialRequest = ReadNextRequest( pConnection, sPipelined );
 
    if( oPotentialRequest.has_value() )
    {
       ProcessNewRequest( pConnection, oPotentialRequest.value() );
    }
 
-   pClient->Close();
+   pConnection->Shutdown();
 }
 
 void HttpServer::PersistentConnection( ClientConnection* pConnection ) const
 {
-   auto pClient = pConnection->m_pClient.get();
+   Http::Arena oArena;     // one per connection, every request reuses the same memory
+   std::string sPipelined; // the requests received behind the one being answered, they outlive the arena
 
    do
    {
-      auto oPotentialRequest = ReadNextRequest( pClient );
+      {
+         Http::ArenaScope oScope( oArena );
+         auto oPotentialRequest = ReadNextRequest( pConnection, sPipelined );
+
+         if( oPotentialRequest.has_value() )
+            ProcessNewRequest( pConnection, oPotentialRequest.value() );
+      }
 
-      if( oPotentialRequest.has_value() )
-         ProcessNewRequest( pConnection, oPotentialRequest.value() );
+      oArena.Reset(); // nothing from the last request is alive past this point
 
    } while( ConnectionIsAlive( pConnection ) );
 
-   pClient->Close();
+   pConnection->Shutdown();
 }
 
-std::optional<HttpRequest> HttpServer::ReadNextRequest( CActiveSocket* pClient )
+// Starts from what was received past the end of the last request, the client may have pipelined the next ones.
+// Whatever arrives past the end of this one is left in pipelined in turn.
+std::optional<HttpRequest> HttpServer::ReadNextRequest( ClientConnection* pConnection, std::string& sPipelined ) const
 {
+   auto pClient = pConnection->m_pClient.get();
+
+   // Close looks for idle connections after it starts draining, one of us is sure to see the other
+   pConnection->m_bIdle = true;
+   if( m_bDraining )
+   {
+      pConnection->Shutdown();
+      return{};
+   }
+
    HttpRequestParser oParser;
-   do
+   std::chrono::steady_clock::time_point tFirstByte;
+   bool bComplete = false;
+   if( !sPipelined.empty() )
+   {
+      tFirstByte = std::chrono::steady_clock::now();
+      pConnection->m_bIdle = false;
+      bComplete = oParser.AppendRequestData( std::exchange( sPipelined, std::string() ) );
+   }
+
+   while( !bComplete )
    {
-      if( pClient->Receive( 2048 ) <= 0 )
+      const auto nReceived = pClient->Receive( 2048 );
+      if( nReceived <= 0 )
       {
-         pClient->Close();
+         pConnection->Shutdown();
          return{};
       }
 
-   } while( !oParser.AppendRequestData( pClient->GetData() ) );
+      if( pConnection->m_bIdle ) tFirstByte = std::chrono::steady_clock::now(); // time spent waiting for the client is not ours
+      pConnection->m_bIdle = false;
+      ServerMetrics::AddBytesReceived( static_cast<size_t>( nReceived ) );
+
+      bComplete = oParser.AppendRequestData( pClient->GetData() );
+   }
+
+   const auto& sExcess = oParser.GetExcessData();
+   sPipelined.assign( sExcess.data(), sExcess.size() );
+
+   HttpRequest oRequest = oParser.GetHttpRequest();
+   ServerMetrics::Record( ServerMetrics::Phase::Read, std::chrono::steady_clock::now() - tFirstByte );
 
-   return oParser.GetHttpRequest();
+   return oRequest;
 }
 
 void HttpServer::ProcessNewRequest( ClientConnection* pConnection, const HttpRequest& oRequest ) const
 {
    pConnection->m_tLastSighting = std::chrono::steady_clock::now();
-   std::cout << "New request from { " << std::hex << pConnection->m_pClient.get() << " }. Remaining :" << std::dec << pConnection->m_nRemainingRequests << std::endl;
 
-   HttpResponse oResponse = BestMatchingServlet( oRequest.GetUri() )->HandleRequest( oRequest );
-   const bool bShouldKeepAlive = oRequest.GetVersion() == Http::Version::v11 && oResponse.GetVersion() == Http::Version::v11 && pConnection->m_nRemainingRequests > 1;
+   HttpResponse oResponse = Dispatch( oRequest );
+   const bool bShouldKeepAlive = oRequest.GetVersion() == Http::Version::v11 && oResponse.GetVersion() == Http::Version::v11 &&
+                                 pConnection->m_nRemainingRequests > 1 && !m_bDraining;
 
    // TODO : Handle HTTP Headers
    oResponse.SetMessageHeader( "Server", "HTTP Server by Christopher McArthur" );
 
    if( bShouldKeepAlive )
-      oResponse.SetMessageHeader( "Keep-Alive", "timeout=100, max=" + std::to_string( pConnection->m_nRemainingRequests ) );
+      oResponse.SetMessageHeader( "Keep-Alive", "timeout=100, max=" + std::to_string( pConnection->m_nRemainingRequests.load() ) );
    else
-      oResponse.SetMessageHeader( "Connection", "closed" );
+      oResponse.SetMessageHeader( "Connection", "close" );
 
-   pConnection->m_pClient->Send( oResponse.GetWireFormat() );
+   ServerMetrics::PhaseTimer oSend( ServerMetrics::Phase::Send );
+   const std::string sWireFormat = oResponse.GetWireFormat();
+   pConnection->m_pClient->Send( sWireFormat );
+   oSend.Stop();
+
+   ServerMetrics::AddBytesSent( sWireFormat.size() );
+   ServerMetrics::CountStatus( oResponse.GetStatusCode() );
    pConnection->m_nRemainingRequests -= 1;
 
-   if( !bShouldKeepAlive )
+   if( Http::AccessLog::IsOpen() )
    {
-      pConnection->m_pClient->Close();
+      char szUri[ Http::AccessLog::RECORD_SIZE ];
+      Http::AccessLog::Write( "request", "client=%p method=%s uri=\"%s\" status=%d bytes=%zu remaining=%zu keep_alive=%d",
+                              static_cast<void*>( pConnection->m_pClient.get() ), HttpRequest::STATIC_MethodAsString( oRequest.GetMethod() ).c_str(),
+                              Http::AccessLog::Escape( oRequest.GetUri(), szUri, sizeof( szUri ) ), static_cast<int>( oResponse.GetStatusCode() ), oResponse.GetBody().size(),
+                              static_cast<size_t>( pConnection->m_nRemainingRequests ), bShouldKeepAlive ? 1 : 0 );
    }
-}
-
-bool HttpServer::UriComparator::operator()( const std::string & lhs, const std::string & rhs ) const
-{
-   if( lhs == "/" )
-      return true;
-
-   if( rhs == "/" )
-      return false;
 
-   const auto lhsDepth = std::count( lhs.begin(), lhs.end(), '/' );
-   const auto rhsDepth = std::count( rhs.begin(), rhs.end(), '/' );
-   if( lhsDepth < rhsDepth )
-      return true;
-
-   if( lhsDepth == rhsDepth )
+   if( !bShouldKeepAlive )
    {
-      std::vector<std::string> tokens_lhs = tokenizeUri( lhs );
-      std::vector<std::string> tokens_rhs = tokenizeUri( rhs );
-
-      for( size_t i = 0; i < tokens_rhs.size(); i++ )
-      {
-         if( tokens_lhs.at( i ) != tokens_rhs.at( i ) )
-         {
-            return tokens_lhs.at( i ) < tokens_rhs.at( i );
-         }
-      }
+      pConnection->Shutdown();
    }
-
-   return false;
-}
-
-std::vector<std::string> HttpServer::UriComparator::tokenizeUri( const std::string& uri )
-{
-   std::istringstream iss_rhs( reduce( uri, " ", "/" ) );
-   return{ std::istream_iterator<std::string>{iss_rhs}, std::istream_iterator<std::string>{} };
 }
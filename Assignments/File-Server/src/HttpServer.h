@@ -27,19 +27,33 @@ SOFTWARE.
 #pragma once
 
 
+#include "ConnectionTable.h"
+#include "CpuTopology.h"
 #include "HttpResponse.h"
 #include "PassiveSocket.h"
-#include <vector>
+#include "ServerMetrics.h"
+#include "UriRouter.h"
+#include <atomic>
+#include <condition_variable>
+#include <functional>
 #include <future>
 #include <memory>
 #include <mutex>
 #include <optional>
+#include <thread>
+#include <vector>
 
 class HttpServlet
 {
 public:
    virtual ~HttpServlet() = default;
    virtual HttpResponse HandleRequest( const HttpRequest& request ) const noexcept = 0;
+
+   // Servlets registered with ":name" segments override this one to see what the URI held in their place
+   virtual HttpResponse HandleRequest( const HttpRequest& request, const UriRouter::Parameters& /* params */ ) const noexcept
+   {
+      return HandleRequest( request );
+   }
 };
 
 //
@@ -49,50 +63,99 @@ class HttpServer
 {
 public:
    HttpServer( Http::Version version = Http::Version::v11 );
+   virtual ~HttpServer(); // servers overriding Dispatch should Close before their own part is destroyed
 
    bool RegisterServlet( const char* uri, HttpServlet* servlet );
 
+   // Answers requests for the URI given with GetMetrics in the Prometheus text format
+   bool ServeMetrics( const char* uri );
+
+   static constexpr uint32_t MAX_CONNECTIONS = 4096; // for each acceptor, unless placed otherwise
+
+   // Where the threads of the server run, the defaults leave a single acceptor free to run anywhere
+   struct Placement
+   {
+      unsigned m_uAcceptors = 1;                        // I/O threads, each with a listener sharing the port
+      uint32_t m_uConnectionsPerAcceptor = MAX_CONNECTIONS; // worker threads, one per connection being served
+      CpuTopology::CpuSet m_vecCpus;                    // where threads may run, anywhere the process may when empty
+      bool m_bNodeLocal = true;                         // serve connections on the NUMA node they were accepted on
+   };
+
    void Launch( unsigned short port );
+   void Launch( unsigned short port, const Placement& placement );
+
+   // Stops accepting and lets the requests in flight finish, keep-alive connections are told to close with their next
+   // response. Whatever is left at the deadline is cut off. Every thread the server started is done once this returns.
+   bool Close( std::chrono::milliseconds drain_deadline = DEFAULT_DRAIN_DEADLINE );
 
-   bool Close();
+   static constexpr std::chrono::milliseconds DEFAULT_DRAIN_DEADLINE{ 5000 };
+
+   size_t GetConnectionCount() const;
+   size_t GetPeakConnectionCount() const; // the high-water marks of every acceptor added up
+
+   ServerMetrics::Snapshot GetMetrics() const;
+
+protected:
+   // Picks the servlet for a request and runs it, the default goes through the routes given to RegisterServlet
+   virtual HttpResponse Dispatch( const HttpRequest& oRequest ) const;
+
+   // Runs the servlet given to RegisterServlet for the request, nothing when none of those routes covers it
+   std::optional<HttpResponse> DispatchRegistered( const HttpRequest& oRequest ) const;
 
 private:
    const Http::Version m_eVersion;
-   CPassiveSocket m_oSocket;
 
    std::unique_ptr<std::promise<void>> m_pExitEvent;
-
-   std::mutex m_muConnectionList;
+   std::atomic<bool> m_bDraining{ false };
+   bool m_bClosed = false;
+   std::vector<std::thread> m_vecThreads; // the acceptors and the cleanup
+
+   std::mutex m_muConnectionThreads;
+   std::condition_variable m_cvConnectionThreads;
+   size_t m_nConnectionThreads = 0;
+
+   //
+   // Any thread that has the entry pinned may shut the socket down, only the last unpin closes it. Its descriptor can
+   // not be handed to a new client while someone could still reach it through the table.
+   //
    struct ClientConnection
    {
       ClientConnection(std::shared_ptr<CActiveSocket>&& client);
+      ~ClientConnection();
+
+      void Shutdown();
 
       std::shared_ptr<CActiveSocket> m_pClient;
-      std::chrono::steady_clock::time_point m_tLastSighting = std::chrono::steady_clock::now();
-      size_t m_nRemainingRequests = 125;
+      std::atomic<std::chrono::steady_clock::time_point> m_tLastSighting{ std::chrono::steady_clock::now() }; // the cleanup thread reads these
+      std::atomic<size_t> m_nRemainingRequests{ 125 };
+      std::atomic<bool> m_bIdle{ true }; // waiting for the next request to start
+      std::atomic<bool> m_bOpen{ true }; // until the first Shutdown, the socket's own state is only the owner's to read
    };
-   std::vector<std::shared_ptr<ClientConnection>> m_vecClients;
-
-   std::condition_variable m_cvCleanSignal;
+   using Connections = ConnectionTable<ClientConnection>;
+   using ConnectionHandle = Connections::Handle;
 
-   struct UriComparator
+   struct Acceptor
    {
-      // Conditions for sorting URIs
-      // - Number of slashes
-      // - Left of relative path
-      bool operator()( const std::string& lhs, const std::string& rhs ) const;
-
-      static std::vector<std::string> tokenizeUri( const std::string& uri );
+      CPassiveSocket m_oSocket;
+      std::unique_ptr<Connections> m_pConnections; // allocated by the acceptor's thread so it lives on that node
+      CpuTopology::CpuSet m_vecAcceptorCpus;
+      CpuTopology::CpuSet m_vecConnectionCpus;
    };
+   std::vector<std::unique_ptr<Acceptor>> m_vecAcceptors;
 
-   std::map<std::string, HttpServlet*, UriComparator> m_RestfulServlets;
+   UriRouter m_Router;
+
+   ServerMetrics m_Metrics;
+   std::unique_ptr<HttpServlet> m_pMetricsServlet;
 
-   HttpServlet* BestMatchingServlet( const std::string& uri ) const;
    void NonPersistentConnection( ClientConnection* pConnection ) const;
    void PersistentConnection( ClientConnection* pClient ) const;
 
-   static std::optional<HttpRequest> ReadNextRequest( CActiveSocket* pClient );
+   std::optional<HttpRequest> ReadNextRequest( ClientConnection* pConnection, std::string& sPipelined ) const;
    void ProcessNewRequest( ClientConnection* pConnection, const HttpRequest& oRequest ) const;
 
+   void ForEachConnection( const std::function<void( ClientConnection& )>& visit );
+   void ConnectionThreadDone();
+
    static bool ConnectionIsAlive( ClientConnection* pConnection );
 };
@@ -0,0 +1,193 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Chris McArthur, prince.chrismc(at)gmail(dot)com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "ServerMetrics.h"
+#include <algorithm>
+#include <cstdio>
+#include <utility>
+
+struct ServerMetrics::Shard
+{
+   std::array<LatencyHistogram, PHASES> m_Phases;
+   std::atomic<uint64_t> m_ulBytesReceived{ 0 };
+   std::atomic<uint64_t> m_ulBytesSent{ 0 };
+   std::array<std::atomic<uint64_t>, STATUS_CODES> m_Statuses{};
+
+   std::atomic<bool> m_bInUse{ true }; // lent to a Scope, handing it over publishes its counts to the next one
+   Shard* m_pNext = nullptr;           // set before the shard joins the list and never after
+
+   void AddTo( Snapshot& snapshot ) const
+   {
+      for( size_t i = 0; i < PHASES; ++i ) m_Phases[ i ].AddTo( snapshot.m_Phases[ i ] );
+      snapshot.m_ulBytesReceived += m_ulBytesReceived.load( std::memory_order_relaxed );
+      snapshot.m_ulBytesSent += m_ulBytesSent.load( std::memory_order_relaxed );
+      for( size_t i = 0; i < STATUS_CODES; ++i ) snapshot.m_Statuses[ i ] += m_Statuses[ i ].load( std::memory_order_relaxed );
+   }
+};
+
+// Only the thread owning the shard writes to it
+static void increment( std::atomic<uint64_t>& counter, uint64_t amount )
+{
+   counter.store( counter.load( std::memory_order_relaxed ) + amount, std::memory_order_relaxed );
+}
+
+static const char* phaseName( ServerMetrics::Phase phase )
+{
+   switch( phase )
+   {
+   case ServerMetrics::Phase::Read: return "read";
+   case ServerMetrics::Phase::Route: return "route";
+   case ServerMetrics::Phase::Handle: return "handle";
+   case ServerMetrics::Phase::Send: return "send";
+   default: return "unknown";
+   }
+}
+
+ServerMetrics::Scope::Scope( ServerMetrics& metrics ) : m_pShard( metrics.acquireShard() )
+{
+   currentShard() = m_pShard;
+}
+
+ServerMetrics::Scope::~Scope()
+{
+   currentShard() = nullptr;
+   m_pShard->m_bInUse.store( false, std::memory_order_release ); // its counts stay, the next connection adds to them
+}
+
+void ServerMetrics::PhaseTimer::Stop()
+{
+   if( m_bStopped ) return;
+   m_bStopped = true;
+
+   Record( m_ePhase, std::chrono::steady_clock::now() - m_tStart );
+}
+
+ServerMetrics::Shard*& ServerMetrics::currentShard()
+{
+   thread_local Shard* s_pCurrentShard = nullptr;
+   return s_pCurrentShard;
+}
+
+ServerMetrics::ServerMetrics() = default;
+
+ServerMetrics::~ServerMetrics()
+{
+   for( Shard* pShard = m_pShards.load( std::memory_order_acquire ); pShard != nullptr; /* no pShard */ )
+      delete std::exchange( pShard, pShard->m_pNext );
+}
+
+ServerMetrics::Shard* ServerMetrics::acquireShard()
+{
+   // Shards are never taken out of the list, walking it needs no lock and only the flag decides who gets one
+   for( Shard* pShard = m_pShards.load( std::memory_order_acquire ); pShard != nullptr; pShard = pShard->m_pNext )
+   {
+      bool bInUse = false;
+      if( !pShard->m_bInUse.load( std::memory_order_relaxed ) &&
+          pShard->m_bInUse.compare_exchange_strong( bInUse, true, std::memory_order_acquire, std::memory_order_relaxed ) )
+         return pShard;
+   }
+
+   // Every shard is lent out, the pool grows by one
+   Shard* pShard = new Shard();
+   pShard->m_pNext = m_pShards.load( std::memory_order_relaxed );
+   while( !m_pShards.compare_exchange_weak( pShard->m_pNext, pShard, std::memory_order_release, std::memory_order_relaxed ) ) {}
+
+   return pShard;
+}
+
+void ServerMetrics::Record( Phase phase, std::chrono::nanoseconds duration )
+{
+   if( Shard* pShard = currentShard() ) pShard->m_Phases[ static_cast<size_t>( phase ) ].Record( duration );
+}
+
+void ServerMetrics::AddBytesReceived( size_t bytes )
+{
+   if( Shard* pShard = currentShard() ) increment( pShard->m_ulBytesReceived, bytes );
+}
+
+void ServerMetrics::AddBytesSent( size_t bytes )
+{
+   if( Shard* pShard = currentShard() ) increment( pShard->m_ulBytesSent, bytes );
+}
+
+void ServerMetrics::CountStatus( Http::Status status )
+{
+   const auto ulCode = static_cast<size_t>( status );
+   if( Shard* pShard = currentShard(); pShard != nullptr && ulCode < STATUS_CODES ) increment( pShard->m_Statuses[ ulCode ], 1 );
+}
+
+ServerMetrics::Snapshot ServerMetrics::Collect() const
+{
+   Snapshot oSnapshot;
+   for( const Shard* pShard = m_pShards.load( std::memory_order_acquire ); pShard != nullptr; pShard = pShard->m_pNext )
+      pShard->AddTo( oSnapshot );
+
+   return oSnapshot;
+}
+
+std::string ServerMetrics::Snapshot::ToPrometheus() const
+{
+   std::string sText;
+   char buffer[ 160 ];
+   const auto append = [ &sText, &buffer ]( int length ) { sText.append( buffer, static_cast<size_t>( std::clamp<int>( length, 0, sizeof( buffer ) - 1 ) ) ); };
+
+   sText.append( "# HELP httpfs_phase_seconds Time spent in each phase of a request.\n# TYPE httpfs_phase_seconds summary\n" );
+   for( size_t i = 0; i < PHASES; ++i )
+   {
+      const char* sPhase = phaseName( static_cast<Phase>( i ) );
+      for( const double dQuantile : { 0.5, 0.9, 0.99, 0.999 } )
+      {
+         const double dSeconds = std::chrono::duration<double>( m_Phases[ i ].ValueAtQuantile( dQuantile ) ).count();
+         append( std::snprintf( buffer, sizeof( buffer ), "httpfs_phase_seconds{phase=\"%s\",quantile=\"%g\"} %.9f\n", sPhase, dQuantile, dSeconds ) );
+      }
+
+      append( std::snprintf( buffer, sizeof( buffer ), "httpfs_phase_seconds_sum{phase=\"%s\"} %.9f\n", sPhase, m_Phases[ i ].m_ulSum / 1e9 ) );
+      append( std::snprintf( buffer, sizeof( buffer ), "httpfs_phase_seconds_count{phase=\"%s\"} %llu\n", sPhase,
+                             static_cast<unsigned long long>( m_Phases[ i ].m_nCount ) ) );
+   }
+
+   sText.append( "# HELP httpfs_requests_total Responses sent by status code.\n# TYPE httpfs_requests_total counter\n" );
+   for( size_t ulCode = 0; ulCode < STATUS_CODES; ++ulCode )
+   {
+      if( m_Statuses[ ulCode ] == 0 ) continue;
+      append( std::snprintf( buffer, sizeof( buffer ), "httpfs_requests_total{status=\"%zu\"} %llu\n", ulCode,
+                             static_cast<unsigned long long>( m_Statuses[ ulCode ] ) ) );
+   }
+
+   sText.append( "# HELP httpfs_received_bytes_total Bytes read from clients.\n# TYPE httpfs_received_bytes_total counter\n" );
+   append( std::snprintf( buffer, sizeof( buffer ), "httpfs_received_bytes_total %llu\n", static_cast<unsigned long long>( m_ulBytesReceived ) ) );
+
+   sText.append( "# HELP httpfs_sent_bytes_total Bytes written to clients.\n# TYPE httpfs_sent_bytes_total counter\n" );
+   append( std::snprintf( buffer, sizeof( buffer ), "httpfs_sent_bytes_total %llu\n", static_cast<unsigned long long>( m_ulBytesSent ) ) );
+
+   sText.append( "# HELP httpfs_connections Connections being served.\n# TYPE httpfs_connections gauge\n" );
+   append( std::snprintf( buffer, sizeof( buffer ), "httpfs_connections %zu\n", m_nConnections ) );
+
+   sText.append( "# HELP httpfs_connections_peak Most connections served at once.\n# TYPE httpfs_connections_peak gauge\n" );
+   append( std::snprintf( buffer, sizeof( buffer ), "httpfs_connections_peak %zu\n", m_nPeakConnections ) );
+
+   return sText;
+}
@@ -0,0 +1,123 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Chris McArthur, prince.chrismc(at)gmail(dot)com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#pragma once
+
+#include "LatencyHistogram.h"
+#include "Constants.h"
+#include <atomic>
+#include <string>
+
+//
+// Where the time goes while serving requests and how much goes through. Each connection thread counts into a shard
+// that is its own for as long as the connection lasts. Shards are pooled, a new connection picks up one left by a
+// connection that is over and keeps adding to it, so once the pool is as big as the most connections served at once
+// neither starting nor ending one takes a lock or allocates. Reading the metrics adds up every shard.
+//
+class ServerMetrics
+{
+public:
+   enum class Phase
+   {
+      Read,   // first byte of the request received until it is parsed
+      Route,  // finding the servlet
+      Handle, // the servlet
+      Send,   // writing the response
+
+      Count
+   };
+
+   static constexpr size_t PHASES = static_cast<size_t>( Phase::Count );
+   static constexpr size_t STATUS_CODES = 600;
+
+   struct Snapshot
+   {
+      std::array<LatencyHistogram::Counts, PHASES> m_Phases;
+      uint64_t m_ulBytesReceived = 0;
+      uint64_t m_ulBytesSent = 0;
+      std::array<uint64_t, STATUS_CODES> m_Statuses{}; // indexed by status code
+
+      size_t m_nConnections = 0;     // filled in by the server, the shards know nothing of connections
+      size_t m_nPeakConnections = 0;
+
+      // Prometheus text exposition format, latencies are summaries in seconds
+      std::string ToPrometheus() const;
+   };
+
+private:
+   struct Shard;
+
+public:
+   // Everything the current thread records until this goes out of scope is added to the metrics given
+   class Scope
+   {
+   public:
+      explicit Scope( ServerMetrics& metrics );
+      ~Scope();
+
+      Scope( const Scope& ) = delete;
+      Scope& operator=( const Scope& ) = delete;
+
+   private:
+      Shard* m_pShard; // owned by the metrics, only lent to this scope
+   };
+
+   // Times a phase from its construction until Stop or its destruction, whichever comes first
+   class PhaseTimer
+   {
+   public:
+      explicit PhaseTimer( Phase phase ) : m_ePhase( phase ), m_tStart( std::chrono::steady_clock::now() ) {}
+      ~PhaseTimer() { Stop(); }
+
+      void Stop();
+      void Discard() { m_bStopped = true; } // nothing is recorded
+
+   private:
+      Phase m_ePhase;
+      std::chrono::steady_clock::time_point m_tStart;
+      bool m_bStopped = false;
+   };
+
+   ServerMetrics();
+   ~ServerMetrics();
+
+   // These do nothing on threads outside of a Scope
+   static void Record( Phase phase, std::chrono::nanoseconds duration );
+   static void AddBytesReceived( size_t bytes );
+   static void AddBytesSent( size_t bytes );
+   static void CountStatus( Http::Status status );
+
+   Snapshot Collect() const;
+
+private:
+   std::atomic<Shard*> m_pShards{ nullptr }; // every shard made so far, only ever added to the front
+
+   ServerMetrics( const ServerMetrics& ) = delete;
+   ServerMetrics& operator=( const ServerMetrics& ) = delete;
+
+   Shard* acquireShard();
+   static Shard*& currentShard(); // the shard of the Scope the calling thread is in
+};
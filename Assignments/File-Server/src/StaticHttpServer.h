@@ -0,0 +1,228 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Chris McArthur, prince.chrismc(at)gmail(dot)com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#pragma once
+
+#include "HttpServer.h"
+#include "Url.h"
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <tuple>
+#include <utility>
+
+namespace StaticRouting
+{
+   // FNV-1a, cheap enough to run one character at a time while walking the URI
+   constexpr uint64_t FNV_OFFSET = 14695981039346656037ULL;
+   constexpr uint64_t FNV_PRIME = 1099511628211ULL;
+
+   constexpr uint64_t Step( uint64_t hash, char c ) { return ( hash ^ static_cast<unsigned char>( c ) ) * FNV_PRIME; }
+
+   constexpr uint64_t Hash( std::string_view text )
+   {
+      uint64_t hash = FNV_OFFSET;
+      for( const char c : text ) hash = Step( hash, c );
+      return hash;
+   }
+
+   template<typename... Routes>
+   constexpr bool AreDistinct()
+   {
+      constexpr std::array<uint64_t, sizeof...( Routes )> hashes{ Routes::HASH... };
+      for( size_t i = 0; i < hashes.size(); ++i )
+         for( size_t j = i + 1; j < hashes.size(); ++j )
+            if( hashes[ i ] == hashes[ j ] ) return false;
+
+      return true;
+   }
+
+   constexpr size_t TableSizeFor( size_t count )
+   {
+      size_t size = 1;
+      while( size < count * 4 ) size *= 2; // sparse enough that some shift of the hashes keeps them apart
+      return size;
+   }
+
+   //
+   // Perfect hash over a fixed set of route hashes, built by the compiler. Each hash is shifted and masked into a
+   // slot of its own, the shift being the first one found that gives no two routes the same slot.
+   //
+   template<size_t Count>
+   struct PerfectHash
+   {
+      static_assert( Count < 255, "Slots hold the index of a route in a byte" );
+
+      static constexpr size_t SIZE = TableSizeFor( Count );
+      static constexpr uint8_t EMPTY = 0xff;
+
+      unsigned m_uShift = 0;
+      std::array<uint8_t, SIZE> m_Slots{};
+      bool m_bFound = false;
+
+      constexpr size_t SlotOf( uint64_t hash ) const { return static_cast<size_t>( hash >> m_uShift ) & ( SIZE - 1 ); }
+      constexpr uint8_t Find( uint64_t hash ) const { return m_Slots[ SlotOf( hash ) ]; } // EMPTY or the only candidate
+   };
+
+   template<size_t Count>
+   constexpr PerfectHash<Count> MakePerfectHash( const std::array<uint64_t, Count>& hashes )
+   {
+      PerfectHash<Count> table;
+      for( unsigned shift = 0; shift < 64 && !table.m_bFound; ++shift )
+      {
+         table.m_uShift = shift;
+         for( auto& slot : table.m_Slots ) slot = PerfectHash<Count>::EMPTY;
+
+         table.m_bFound = true;
+         for( size_t i = 0; i < Count && table.m_bFound; ++i )
+         {
+            auto& slot = table.m_Slots[ table.SlotOf( hashes[ i ] ) ];
+            table.m_bFound = ( slot == PerfectHash<Count>::EMPTY );
+            slot = static_cast<uint8_t>( i );
+         }
+      }
+
+      return table;
+   }
+}
+
+//
+// A route known at build time. The URI must outlive the program, declare it as a constexpr char array.
+//
+//    static constexpr char FAVICON_URI[] = "/favicon.ico";
+//    using FaviconRoute = StaticRoute<FAVICON_URI, IconServlet>;
+//
+template<const char* Uri, typename Servlet>
+struct StaticRoute
+{
+   using ServletType = Servlet;
+
+   static constexpr std::string_view URI{ Uri };
+   static_assert( !URI.empty() && URI.front() == '/', "Routes must start with a '/'" );
+   static_assert( URI.find( ':' ) == std::string_view::npos, "Path parameters are only supported by RegisterServlet" );
+
+   // Compared without its trailing slash, "/" becomes the empty prefix which every URI starts with
+   static constexpr std::string_view PREFIX = URI.back() == '/' ? URI.substr( 0, URI.size() - 1 ) : URI;
+   static constexpr uint64_t HASH = StaticRouting::Hash( PREFIX );
+};
+
+//
+// HTTP server whose routes are fixed at compile time. The compiler hashes every route and lays them out in a perfect
+// hash table, a request is matched by hashing its URI once and looking up a single slot at each '/'. The servlet is
+// then called directly, without going through the vtable.
+//
+// Anything the table does not cover falls back to the servlets given to RegisterServlet so both can live in the same
+// server. A route at "/" covers every URI, when that is all the table found the registered routes go first since any
+// of them is at least as deep.
+//
+template<typename... Routes>
+class StaticHttpServer : public HttpServer
+{
+   static_assert( sizeof...( Routes ) > 0, "Use HttpServer when there are no static routes" );
+   static_assert( StaticRouting::AreDistinct<Routes...>(), "Two routes share a hash, or the same URI was declared twice" );
+
+public:
+   explicit StaticHttpServer( Http::Version version, typename Routes::ServletType&... servlets )
+      : HttpServer( version )
+      , m_Servlets( servlets... )
+   {
+   }
+
+   ~StaticHttpServer() override { Close(); } // connections still call Dispatch until then
+
+protected:
+   HttpResponse Dispatch( const HttpRequest& oRequest ) const override
+   {
+      ServerMetrics::PhaseTimer oRoute( ServerMetrics::Phase::Route );
+      const auto target = Http::Url::ParseRequestTarget( oRequest.GetUri() );
+      const std::string_view path = target.has_value() ? target->m_sPath : std::string_view{};
+
+      // Deepest route wins, walking forward means the last one found
+      size_t nRoute = NO_ROUTE;
+      uint64_t hash = StaticRouting::FNV_OFFSET;
+      for( size_t pos = 0; /* no condition */; ++pos )
+      {
+         if( pos == path.size() || path[ pos ] == '/' )
+         {
+            // Hashes only pick the candidate, comparing the text guards against a URI colliding with a route
+            const uint8_t uSlot = TABLE.Find( hash );
+            if( uSlot != Table::EMPTY && HASHES[ uSlot ] == hash && PREFIXES[ uSlot ] == path.substr( 0, pos ) )
+               nRoute = uSlot;
+         }
+
+         if( pos == path.size() ) break;
+
+         hash = StaticRouting::Step( hash, path[ pos ] );
+      }
+
+      if( nRoute == NO_ROUTE || PREFIXES[ nRoute ].empty() )
+      {
+         oRoute.Discard(); // the lookup that follows is timed on its own
+         if( std::optional<HttpResponse> oResponse = DispatchRegistered( oRequest ) )
+            return std::move( *oResponse );
+
+         if( nRoute == NO_ROUTE )
+            return HttpResponse( oRequest.GetVersion(), Http::Status::NotFound, "NOT FOUND" );
+      }
+      else
+      {
+         oRoute.Stop();
+      }
+
+      ServerMetrics::PhaseTimer oHandle( ServerMetrics::Phase::Handle );
+      return invoke( nRoute, oRequest, std::index_sequence_for<Routes...>{} );
+   }
+
+private:
+   static constexpr size_t NO_ROUTE = sizeof...( Routes );
+
+   using Table = StaticRouting::PerfectHash<sizeof...( Routes )>;
+   static constexpr std::array<uint64_t, sizeof...( Routes )> HASHES{ Routes::HASH... };
+   static constexpr std::array<std::string_view, sizeof...( Routes )> PREFIXES{ Routes::PREFIX... };
+   static constexpr Table TABLE = StaticRouting::MakePerfectHash( HASHES );
+   static_assert( TABLE.m_bFound, "No shift of the route hashes gives each route a slot of its own, rename one of them" );
+
+   std::tuple<typename Routes::ServletType&...> m_Servlets;
+
+   template<size_t... I>
+   HttpResponse invoke( size_t nRoute, const HttpRequest& oRequest, std::index_sequence<I...> ) const
+   {
+      std::optional<HttpResponse> oResponse;
+      ( void )( ( nRoute == I && ( oResponse.emplace( call<I>( oRequest ) ), true ) ) || ... );
+
+      return std::move( *oResponse );
+   }
+
+   template<size_t I>
+   HttpResponse call( const HttpRequest& oRequest ) const
+   {
+      using Servlet = typename std::tuple_element_t<I, std::tuple<Routes...>>::ServletType;
+
+      // Qualified so the call is bound at compile time instead of through the vtable
+      return std::get<I>( m_Servlets ).Servlet::HandleRequest( oRequest );
+   }
+};
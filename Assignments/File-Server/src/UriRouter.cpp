@@ -0,0 +1,196 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Chris McArthur, prince.chrismc(at)gmail(dot)com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "UriRouter.h"
+#include "Url.h"
+#include <algorithm>
+
+static std::string_view firstSegment( std::string_view path )
+{
+   return path.substr( 0, path.find( '/' ) );
+}
+
+static std::string_view skipSlashes( std::string_view path )
+{
+   const auto start = path.find_first_not_of( '/' );
+   return start == std::string_view::npos ? std::string_view{} : path.substr( start );
+}
+
+// The whole edge must be there and end on a segment boundary, "/files" is no prefix of "/filesystem"
+static bool matchesEdge( std::string_view label, std::string_view path )
+{
+   return path.compare( 0, label.size(), label ) == 0 && ( path.size() == label.size() || path[ label.size() ] == '/' );
+}
+
+UriRouter::UriRouter() : m_Root( std::make_unique<Node>() )
+{
+}
+
+UriRouter::~UriRouter() = default;
+
+bool UriRouter::Register( std::string_view route, HttpServlet* servlet )
+{
+   if( servlet == nullptr || route.empty() || route.front() != '/' ) return false;
+
+   std::vector<std::string_view> segments;
+   for( auto remaining = skipSlashes( route ); !remaining.empty(); remaining = skipSlashes( remaining ) )
+   {
+      segments.push_back( firstSegment( remaining ) );
+      remaining.remove_prefix( segments.back().size() );
+   }
+
+   Node* node = m_Root.get();
+   for( size_t i = 0; i < segments.size(); /* no i */ )
+   {
+      const auto segment = segments[ i ];
+      if( segment.front() == ':' )
+      {
+         const auto name = segment.substr( 1 );
+         if( name.empty() ) return false;
+
+         if( node->m_Parameter == nullptr )
+         {
+            node->m_Parameter = std::make_unique<Node>();
+            node->m_Parameter->m_Label = name;
+         }
+         else if( node->m_Parameter->m_Label != name )
+         {
+            return false; // the same position can't be known under two names
+         }
+
+         node = node->m_Parameter.get();
+         ++i;
+         continue;
+      }
+
+      Node* child = findChild( *node, segment );
+      if( child == nullptr )
+      {
+         // Nothing shares this path yet, every static segment up to the next parameter fits on a single edge
+         auto fresh = std::make_unique<Node>();
+         for( ; i < segments.size() && segments[ i ].front() != ':'; ++i )
+         {
+            if( !fresh->m_Label.empty() ) fresh->m_Label += '/';
+            fresh->m_Label += segments[ i ];
+         }
+
+         const auto itor = std::lower_bound( node->m_Children.begin(), node->m_Children.end(), segment,
+                                             []( const std::unique_ptr<Node>& lhs, std::string_view rhs ) { return firstSegment( lhs->m_Label ) < rhs; } );
+         node = node->m_Children.insert( itor, std::move( fresh ) )->get();
+         continue;
+      }
+
+      // Walk along the edge for as long as the route agrees with it
+      const std::string_view label = child->m_Label;
+      size_t shared = 0;
+      size_t labelPos = 0;
+      bool bWholeEdge = false;
+      while( i + shared < segments.size() )
+      {
+         const auto edgeSegment = firstSegment( label.substr( labelPos ) );
+         if( edgeSegment != segments[ i + shared ] ) break;
+
+         ++shared;
+         labelPos += edgeSegment.size();
+         if( labelPos == label.size() ) { bWholeEdge = true; break; }
+         ++labelPos; // separator
+      }
+
+      if( !bWholeEdge )
+      {
+         // Split where the route diverges, everything the child had moves down to the tail of the edge
+         auto tail = std::make_unique<Node>();
+         tail->m_Label = label.substr( labelPos );
+         tail->m_Servlet = child->m_Servlet;
+         tail->m_Children = std::move( child->m_Children );
+         tail->m_Parameter = std::move( child->m_Parameter );
+
+         child->m_Label.resize( labelPos - 1 );
+         child->m_Servlet = nullptr;
+         child->m_Children.clear();
+         child->m_Children.push_back( std::move( tail ) );
+      }
+
+      node = child;
+      i += shared;
+   }
+
+   if( node->m_Servlet != nullptr ) return false;
+
+   node->m_Servlet = servlet;
+   return true;
+}
+
+UriRouter::Match UriRouter::Find( std::string_view uri ) const
+{
+   Match best;
+   Parameters params;
+
+   const Node* node = m_Root.get();
+   best.m_Servlet = node->m_Servlet;
+
+   const auto target = Http::Url::ParseRequestTarget( uri );
+   auto path = skipSlashes( target.has_value() ? target->m_sPath : std::string_view{} ); // a malformed one only reaches the root
+   while( !path.empty() )
+   {
+      const auto segment = firstSegment( path );
+
+      if( const Node* child = findChild( *node, segment ); child != nullptr && matchesEdge( child->m_Label, path ) )
+      {
+         path.remove_prefix( child->m_Label.size() );
+         node = child;
+      }
+      else if( node->m_Parameter != nullptr && params.Push( node->m_Parameter->m_Label, segment ) )
+      {
+         path.remove_prefix( segment.size() );
+         node = node->m_Parameter.get();
+      }
+      else
+      {
+         break;
+      }
+
+      path = skipSlashes( path );
+
+      if( node->m_Servlet != nullptr )
+      {
+         best.m_Servlet = node->m_Servlet;
+         best.m_Parameters = params;
+      }
+   }
+
+   return best;
+}
+
+UriRouter::Node* UriRouter::findChild( const Node& node, std::string_view segment )
+{
+   const auto itor = std::lower_bound( node.m_Children.begin(), node.m_Children.end(), segment,
+                                       []( const std::unique_ptr<Node>& lhs, std::string_view rhs ) { return firstSegment( lhs->m_Label ) < rhs; } );
+
+   if( itor == node.m_Children.end() || firstSegment( ( *itor )->m_Label ) != segment ) return nullptr;
+
+   return itor->get();
+}
@@ -0,0 +1,111 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Chris McArthur, prince.chrismc(at)gmail(dot)com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#pragma once
+
+#include <array>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class HttpServlet;
+
+//
+// Routes request URIs to servlets with a radix trie over path segments. Chains of segments without a servlet of their
+// own are compressed into a single edge so a lookup costs one comparison per segment of the URI and allocates nothing.
+//
+// Routes are segment aligned, "/files" matches "/files" and "/files/a.txt" but not "/filesystem". A segment written as
+// ":name" captures whatever the URI has in that position, for instance "/users/:id/avatar". When both could apply a
+// static segment wins over a parameter, the deepest route with a servlet along the way is the one returned.
+//
+class UriRouter
+{
+public:
+   static constexpr size_t MAX_PARAMETERS = 8;
+
+   struct Parameter
+   {
+      std::string_view m_Name;
+      std::string_view m_Value;
+   };
+
+   // Views into the registered route and the request URI, only valid while both are alive
+   class Parameters
+   {
+   public:
+      const Parameter* begin() const { return m_Values.data(); }
+      const Parameter* end() const { return m_Values.data() + m_Size; }
+      size_t size() const { return m_Size; }
+      bool empty() const { return m_Size == 0; }
+
+      std::optional<std::string_view> Find( std::string_view name ) const
+      {
+         for( const auto& param : *this )
+            if( param.m_Name == name ) return param.m_Value;
+
+         return std::nullopt;
+      }
+
+      bool Push( std::string_view name, std::string_view value )
+      {
+         if( m_Size == m_Values.size() ) return false;
+
+         m_Values[ m_Size++ ] = { name, value };
+         return true;
+      }
+
+   private:
+      std::array<Parameter, MAX_PARAMETERS> m_Values{};
+      size_t m_Size = 0;
+   };
+
+   struct Match
+   {
+      HttpServlet* m_Servlet = nullptr;
+      Parameters m_Parameters;
+   };
+
+   UriRouter();
+   ~UriRouter();
+
+   bool Register( std::string_view route, HttpServlet* servlet ); // false when malformed or already taken
+   Match Find( std::string_view uri ) const;
+
+private:
+   struct Node
+   {
+      std::string m_Label; // static segments joined by '/', or the name of a parameter
+      HttpServlet* m_Servlet = nullptr;
+      std::vector<std::unique_ptr<Node>> m_Children; // sorted by first segment, which is unique among siblings
+      std::unique_ptr<Node> m_Parameter;
+   };
+
+   std::unique_ptr<Node> m_Root;
+
+   static Node* findChild( const Node& node, std::string_view segment );
+};
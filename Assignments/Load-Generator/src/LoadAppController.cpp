@@ -0,0 +1,205 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Chris McArthur, prince.chrismc(at)gmail(dot)com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "LoadAppController.h"
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+LoadAppController::LoadAppController( int argc, char ** argv ) : m_CliParser( argc, argv )
+{
+}
+
+void LoadAppController::Initialize()
+{
+   if( m_CliParser.cbegin() == m_CliParser.cend() || *m_CliParser.cbegin() == "help" )
+   {
+      printGeneralUsage();
+      throw std::invalid_argument( "Missing 'URL' paramater" );
+   }
+
+   try
+   {
+      m_Options.m_oTarget = HrefParser().Parse( *( m_CliParser.cend() - 1 ) ).GetHref();
+   }
+   catch( const HrefParser::ParseError& )
+   {
+      printGeneralUsage();
+      throw;
+   }
+
+   if( m_CliParser.DoesSwitchExists( "-c" ) )
+   {
+      try
+      {
+         m_Options.m_uConnections = static_cast<unsigned>( std::stoul( *++m_CliParser.find( "-c" ) ) );
+      }
+      catch( ... )
+      {
+         printGeneralUsage();
+         throw std::logic_error( "Invalid number of connections specified!" );
+      }
+   }
+
+   if( m_CliParser.DoesSwitchExists( "-r" ) )
+   {
+      try
+      {
+         m_Options.m_dRate = std::stod( *++m_CliParser.find( "-r" ) );
+         if( m_Options.m_dRate <= 0.0 ) throw std::invalid_argument( "not positive" );
+      }
+      catch( ... )
+      {
+         printGeneralUsage();
+         throw std::logic_error( "Invalid request rate specified!" );
+      }
+   }
+
+   if( m_CliParser.DoesSwitchExists( "-t" ) )
+   {
+      try
+      {
+         m_Options.m_Duration = std::chrono::seconds( std::stoul( *++m_CliParser.find( "-t" ) ) );
+      }
+      catch( ... )
+      {
+         printGeneralUsage();
+         throw std::logic_error( "Invalid duration specified!" );
+      }
+   }
+
+   if( m_CliParser.DoesSwitchExists( "-p" ) )
+   {
+      try
+      {
+         m_Options.m_uPostPercent = static_cast<unsigned>( std::stoul( *++m_CliParser.find( "-p" ) ) );
+         if( m_Options.m_uPostPercent > 100 ) throw std::out_of_range( "percentage" );
+      }
+      catch( ... )
+      {
+         printGeneralUsage();
+         throw std::logic_error( "Invalid share of POST requests specified!" );
+      }
+   }
+
+   if( m_CliParser.DoesSwitchExists( "-d" ) && m_CliParser.DoesSwitchExists( "-f" ) )
+   {
+      printGeneralUsage();
+      throw std::logic_error( "Either -d or -f can be used but not both!" );
+   }
+
+   if( m_CliParser.DoesSwitchExists( "-d" ) )
+   {
+      m_Options.m_sBody = *++m_CliParser.find( "-d" );
+   }
+   else if( m_CliParser.DoesSwitchExists( "-f" ) )
+   {
+      std::ifstream fileReader( *++m_CliParser.find( "-f" ), std::ios::in | std::ios::binary | std::ios::ate );
+      if( !fileReader ) { printGeneralUsage(); throw std::invalid_argument( "Unable to use file specified with -f switch" ); }
+
+      const size_t size = fileReader.tellg();
+      m_Options.m_sBody.resize( size, '\0' );
+      fileReader.seekg( 0 ); // rewind
+      fileReader.read( m_Options.m_sBody.data(), size );
+   }
+}
+
+void LoadAppController::Run()
+{
+   const LoadGenerator oGenerator( m_Options );
+
+   std::cout << "Running for " << m_Options.m_Duration.count() << "s against " << m_Options.m_oTarget.m_sHostName << ":"
+             << m_Options.m_oTarget.m_nPortNumber << m_Options.m_oTarget.m_sUri << " over " << m_Options.m_uConnections << " connections, ";
+   if( m_Options.m_dRate > 0.0 )
+      std::cout << m_Options.m_dRate << " requests per second" << std::endl;
+   else
+      std::cout << "each sending as soon as it is answered" << std::endl;
+
+   printReport( m_Options, oGenerator.Run() );
+}
+
+//
+// Printing
+//
+static void printLatencies( const char* title, const LatencyHistogram::Counts& counts )
+{
+   const auto milliseconds = []( std::chrono::nanoseconds value ) { return std::chrono::duration<double, std::milli>( value ).count(); };
+
+   std::printf( "%s\n", title );
+   std::printf( "   %10s %10s %10s %10s %10s %10s %10s\n", "mean", "p50", "p90", "p99", "p99.9", "p99.99", "max" );
+   std::printf( "   %10.3f %10.3f %10.3f %10.3f %10.3f %10.3f %10.3f   ms\n",
+                counts.m_nCount ? counts.m_ulSum / 1e6 / counts.m_nCount : 0.0,
+                milliseconds( counts.ValueAtQuantile( 0.5 ) ), milliseconds( counts.ValueAtQuantile( 0.9 ) ),
+                milliseconds( counts.ValueAtQuantile( 0.99 ) ), milliseconds( counts.ValueAtQuantile( 0.999 ) ),
+                milliseconds( counts.ValueAtQuantile( 0.9999 ) ), milliseconds( counts.ValueAtQuantile( 1.0 ) ) );
+}
+
+void LoadAppController::printReport( const LoadGenerator::Options& options, const LoadGenerator::Report& report )
+{
+   const double dSeconds = report.m_Elapsed.count();
+
+   std::printf( "\n%llu requests in %.2fs, %.1f per second\n", static_cast<unsigned long long>( report.m_nRequests ), dSeconds,
+                report.m_nRequests / dSeconds );
+   std::printf( "%llu errors, %llu connections opened\n", static_cast<unsigned long long>( report.m_nErrors ),
+                static_cast<unsigned long long>( report.m_nConnects ) );
+   std::printf( "%.2f MB sent, %.2f MB received\n", report.m_ulBytesSent / 1e6, report.m_ulBytesReceived / 1e6 );
+
+   for( const auto& [ nStatus, nCount ] : report.m_Statuses )
+      std::printf( "   status %d: %llu\n", nStatus, static_cast<unsigned long long>( nCount ) );
+
+   std::printf( "\n" );
+   if( options.m_dRate > 0.0 )
+      printLatencies( "Latency, from when each request was due (corrected for coordinated omission)", report.m_oLatency );
+   else
+      printLatencies( "Latency, closed loop so requests are never late (give a rate with -r to correct for coordinated omission)", report.m_oLatency );
+
+   printLatencies( "Service time, from when each request was sent", report.m_oServiceTime );
+}
+
+/*
+General Usage
+   httpload help
+httpload opens persistent connections to an HTTP server and reports its throughput and latency.
+Usage:
+   httpload [-c CONNECTIONS] [-r RATE] [-t SECONDS] [-p PERCENT] [-d inline-data | -f file] URL
+-c Specifies how many connections send requests, each from its own thread. Default is 8.
+-r Specifies how many requests per second to send across every connection. By default each connection sends its next request as soon as the last one is answered.
+-t Specifies how many seconds to run for. Default is 10.
+-p Specifies the percentage of requests that are POST rather than GET. Default is 0.
+-d Associates an inline data to the body of the POST requests.
+-f Associates the content of a file to the body of the POST requests.
+ */
+void LoadAppController::printGeneralUsage()
+{
+   std::cout << "General Usage\r\n   httpload help\r\nhttpload opens persistent connections to an HTTP server and reports its throughput and latency.\r\nUsage:\r\n";
+   std::cout << "   httpload [-c CONNECTIONS] [-r RATE] [-t SECONDS] [-p PERCENT] [-d inline-data | -f file] URL\r\n";
+   std::cout << "-c Specifies how many connections send requests, each from its own thread. Default is 8.\r\n";
+   std::cout << "-r Specifies how many requests per second to send across every connection. By default each connection sends its next request as soon as the last one is answered.\r\n";
+   std::cout << "-t Specifies how many seconds to run for. Default is 10.\r\n";
+   std::cout << "-p Specifies the percentage of requests that are POST rather than GET. Default is 0.\r\n";
+   std::cout << "-d Associates an inline data to the body of the POST requests.\r\n";
+   std::cout << "-f Associates the content of a file to the body of the POST requests." << std::endl;
+}
@@ -0,0 +1,192 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Chris McArthur, prince.chrismc(at)gmail(dot)com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "LoadGenerator.h"
+#include "HttpResponse.h"
+#include "ActiveSocket.h"
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+static std::unique_ptr<CActiveSocket> openConnection( const Href& target, std::chrono::seconds timeout )
+{
+   auto pSocket = std::make_unique<CActiveSocket>();
+   if( !pSocket->Open( target.m_sHostName.c_str(), target.m_nPortNumber ) ) return nullptr;
+
+   pSocket->SetReceiveTimeout( static_cast<int32_t>( timeout.count() ), 0 );
+   return pSocket;
+}
+
+static void closeConnection( std::unique_ptr<CActiveSocket>& socket )
+{
+   socket->Close();
+   socket.reset();
+}
+
+static std::string buildRequest( Http::RequestMethod method, const Href& target, const std::string& body )
+{
+   HttpRequest oRequest( method, target.m_sUri, Http::Version::v11, target.m_sHostName + ":" + std::to_string( target.m_nPortNumber ) );
+   oRequest.AppendMessageBody( body );
+   return oRequest.GetWireFormat();
+}
+
+void LoadGenerator::Report::Merge( const Report& other )
+{
+   m_nRequests += other.m_nRequests;
+   m_nErrors += other.m_nErrors;
+   m_nConnects += other.m_nConnects;
+   m_ulBytesSent += other.m_ulBytesSent;
+   m_ulBytesReceived += other.m_ulBytesReceived;
+   for( const auto& [ nStatus, nCount ] : other.m_Statuses ) m_Statuses[ nStatus ] += nCount;
+   m_oLatency.Merge( other.m_oLatency );
+   m_oServiceTime.Merge( other.m_oServiceTime );
+}
+
+LoadGenerator::LoadGenerator( const Options& options )
+   : m_oOptions( options )
+   , m_sGetRequest( buildRequest( Http::RequestMethod::Get, options.m_oTarget, "" ) )
+   , m_sPostRequest( buildRequest( Http::RequestMethod::Post, options.m_oTarget, options.m_sBody ) )
+{
+   if( m_oOptions.m_uConnections == 0 ) throw std::invalid_argument( "At least one connection is required!" );
+   if( m_oOptions.m_uPostPercent > 100 ) throw std::invalid_argument( "The share of POST requests is a percentage!" );
+}
+
+LoadGenerator::Report LoadGenerator::Run() const
+{
+   const auto tStart = std::chrono::steady_clock::now();
+
+   std::vector<Report> vecReports( m_oOptions.m_uConnections );
+   std::vector<std::thread> vecThreads;
+   for( unsigned uIndex = 0; uIndex < m_oOptions.m_uConnections; uIndex += 1 )
+      vecThreads.emplace_back( [ this, uIndex, tStart, &oReport = vecReports[ uIndex ] ] { oReport = runConnection( uIndex, tStart ); } );
+
+   for( auto& oThread : vecThreads ) oThread.join();
+
+   Report oTotal;
+   for( const auto& oReport : vecReports ) oTotal.Merge( oReport );
+   oTotal.m_Elapsed = std::chrono::steady_clock::now() - tStart;
+
+   return oTotal;
+}
+
+LoadGenerator::Report LoadGenerator::runConnection( unsigned index, std::chrono::steady_clock::time_point start ) const
+{
+   Report oReport;
+   auto pLatency = std::make_unique<LatencyHistogram>();
+   auto pServiceTime = std::make_unique<LatencyHistogram>();
+   std::minstd_rand oRandom( index + 1 );
+
+   const auto tEnd = start + m_oOptions.m_Duration;
+   const bool bFixedRate = m_oOptions.m_dRate > 0.0;
+   const auto interval = bFixedRate ? std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                         std::chrono::duration<double>( m_oOptions.m_uConnections / m_oOptions.m_dRate ) )
+                                    : std::chrono::steady_clock::duration::zero();
+
+   // Spread the connections over the first interval so they do not all fire at once
+   auto tDue = start + interval * index / m_oOptions.m_uConnections;
+
+   std::unique_ptr<CActiveSocket> pSocket;
+   while( true )
+   {
+      const auto tNow = std::chrono::steady_clock::now();
+      if( bFixedRate )
+      {
+         if( tDue >= tEnd ) break;
+         if( tDue > tNow ) std::this_thread::sleep_until( tDue ); // when behind the requests go out back to back until caught up
+      }
+      else
+      {
+         if( tNow >= tEnd ) break;
+         tDue = tNow;
+      }
+
+      const auto tScheduled = tDue;
+      tDue += interval;
+
+      if( pSocket == nullptr )
+      {
+         pSocket = openConnection( m_oOptions.m_oTarget, m_oOptions.m_Timeout );
+         oReport.m_nConnects += 1;
+
+         if( pSocket == nullptr )
+         {
+            oReport.m_nErrors += 1;
+            if( !bFixedRate ) std::this_thread::sleep_for( 1ms ); // the schedule already paces the retries
+            continue;
+         }
+      }
+
+      const bool bPost = oRandom() % 100 < m_oOptions.m_uPostPercent;
+      const std::string& sRequest = bPost ? m_sPostRequest : m_sGetRequest;
+
+      const auto tSent = std::chrono::steady_clock::now();
+      if( pSocket->Send( reinterpret_cast<const uint8_t*>( sRequest.data() ), sRequest.size() ) != static_cast<int32_t>( sRequest.size() ) )
+      {
+         oReport.m_nErrors += 1;
+         closeConnection( pSocket );
+         continue;
+      }
+      oReport.m_ulBytesSent += sRequest.size();
+
+      HttpResponseParser oParser;
+      bool bComplete = false;
+      do
+      {
+         const auto nReceived = pSocket->Receive( 4096 );
+         if( nReceived <= 0 ) break;
+
+         oReport.m_ulBytesReceived += static_cast<uint64_t>( nReceived );
+         bComplete = oParser.AppendResponseData( pSocket->GetData() );
+      } while( !bComplete );
+
+      const auto tAnswered = std::chrono::steady_clock::now();
+      if( !bComplete )
+      {
+         oReport.m_nErrors += 1;
+         closeConnection( pSocket );
+         continue;
+      }
+
+      pLatency->Record( tAnswered - tScheduled );
+      pServiceTime->Record( tAnswered - tSent );
+      oReport.m_nRequests += 1;
+
+      HttpResponse oResponse = oParser.GetHttpResponse();
+      oReport.m_Statuses[ static_cast<int>( oResponse.GetStatusCode() ) ] += 1;
+
+      if( oResponse.GetVersion() != Http::Version::v11 || oResponse.HasMessageHeader( "Connection", "close" ) )
+         closeConnection( pSocket ); // the server is done with this connection, the next request opens another
+   }
+
+   if( pSocket != nullptr ) closeConnection( pSocket );
+
+   pLatency->AddTo( oReport.m_oLatency );
+   pServiceTime->AddTo( oReport.m_oServiceTime );
+   return oReport;
+}
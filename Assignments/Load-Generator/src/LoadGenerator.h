@@ -0,0 +1,83 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Chris McArthur, prince.chrismc(at)gmail(dot)com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#pragma once
+
+#include "Href.h"
+#include "LatencyHistogram.h"
+#include <chrono>
+#include <map>
+#include <string>
+
+//
+// Drives an HTTP server from a set of persistent connections, each one on a thread of its own.
+//
+// Without a rate each connection sends its next request as soon as the last response arrives. With one the requests
+// follow a fixed schedule and latency is measured from when each one was due rather than from when it went out, so
+// a server that stalls is charged for every request that should have been sent during the stall. Service time,
+// from send to response, is reported alongside for comparison.
+//
+class LoadGenerator
+{
+public:
+   struct Options
+   {
+      Href m_oTarget;
+      unsigned m_uConnections = 8;
+      double m_dRate = 0.0;                        // requests per second over every connection, closed loop when zero
+      std::chrono::seconds m_Duration{ 10 };
+      unsigned m_uPostPercent = 0;                 // the rest are GET requests
+      std::string m_sBody;                         // sent with every POST request
+      std::chrono::seconds m_Timeout{ 2 };         // a response taking longer counts as an error
+   };
+
+   struct Report
+   {
+      std::chrono::duration<double> m_Elapsed{ 0 };
+      uint64_t m_nRequests = 0;                    // answered
+      uint64_t m_nErrors = 0;                      // failed to connect, send or receive
+      uint64_t m_nConnects = 0;
+      uint64_t m_ulBytesSent = 0;
+      uint64_t m_ulBytesReceived = 0;
+      std::map<int, uint64_t> m_Statuses;
+      LatencyHistogram::Counts m_oLatency;         // from when the request was due
+      LatencyHistogram::Counts m_oServiceTime;     // from when the request was sent
+
+      void Merge( const Report& other );
+   };
+
+   explicit LoadGenerator( const Options& options );
+
+   // Blocks for the duration of the run
+   Report Run() const;
+
+private:
+   Options m_oOptions;
+   std::string m_sGetRequest;  // built once, every request sends the same bytes
+   std::string m_sPostRequest;
+
+   Report runConnection( unsigned index, std::chrono::steady_clock::time_point start ) const;
+};
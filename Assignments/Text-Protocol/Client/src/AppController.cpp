@@ -29,6 +29,9 @@ SOFTWARE.
 #include <sstream>
 #include <stdexcept>
 #include "Socket.h"
+#include "Router.h"
+#include "Transport.h"
+#include <algorithm>
 
 #ifdef _WIN32
 #include <Ws2tcpip.h>
@@ -83,9 +86,20 @@ void CurlAppController::Run()
 {
    validateCommand();
 
-   establishConnection();
+   connectToRouter();
 
-   sendHttpRequest();
+   if( !resumeSession() )
+      establishConnection();
+
+   if( !sendHttpRequest() )
+   {
+      // Token expired or the server restarted since, pay for the handshake this time around
+      debugPrint( "Server refused to resume the session, falling back to the handshake\r\n" );
+      m_Sessions.Forget( m_ServerIp, m_ServerPort );
+
+      establishConnection();
+      sendHttpRequest();
+   }
 
    receiveHttpResponse();
 
@@ -236,26 +250,52 @@ void CurlAppController::validateCommand() const
    }
 }
 
-void CurlAppController::establishConnection()
+void CurlAppController::connectToRouter()
 {
    debugPrint( "Connectioning to router...\r\n" );
 
-   if( !m_Client.Open( m_oHref.m_sHostName.c_str(), 3000 ) )
+   if( !m_Client.Open( m_oHref.m_sHostName.c_str(), TextProtocol::Router::PORT ) )
    {
       debugPrint( "Establish connection failed because ", m_Client.DescribeError(), "\r\n" );
       throw std::runtime_error( "Failed to establish connection with router" );
    }
 
-
-
    sockaddr_in sa{};
    // store this IP address in sa:
    inet_pton( AF_INET, m_Client.GetServerAddr().c_str(), &( sa.sin_addr ) );
-   const TextProtocol::IpV4Address serverIp{ sa.sin_addr.s_addr };
+   m_ServerIp = TextProtocol::IpV4Address{ sa.sin_addr.s_addr };
+}
+
+bool CurlAppController::resumeSession()
+{
+   // What goes out ahead of the handshake can be replayed by whoever sees it, the server only takes a GET that way
+   if( m_eCommand != Http::RequestMethod::Get ) return false;
+
+   const auto token = m_Sessions.Find( m_ServerIp, m_ServerPort );
+   if( !token.has_value() ) return false;
+
+   // Stands in for both the SYN and the SYN_ACK so the request can follow right away without waiting on the server
+   m_Expected = TextProtocol::SequenceNumber{ 1 };
+   TextProtocol::Message resumeMessage( TextProtocol::PacketType::RESUME, m_Expected++, m_ServerIp, m_ServerPort );
+   resumeMessage.m_Payload = *token;
+
+   debugPrint( "Resuming previous session with Server... Sending >> ", resumeMessage, "\r\n" );
+   if( !TextProtocol::Socket::Send( m_Client, resumeMessage ) )
+   {
+      debugPrint( "Unable to send message because ", m_Client.DescribeError(), "\r\n" );
+      return false;
+   }
 
-   const TextProtocol::PortNumber serverPort{ 8080 };
+   m_bResuming = true;
+   return true;
+}
+
+void CurlAppController::establishConnection()
+{
+   m_bResuming = false;
+   m_Expected = TextProtocol::SequenceNumber{ 0 };
 
-   const TextProtocol::Message synMessage( TextProtocol::PacketType::SYN, m_Expected++, serverIp, serverPort );
+   const TextProtocol::Message synMessage( TextProtocol::PacketType::SYN, m_Expected++, m_ServerIp, m_ServerPort );
 
    debugPrint( "Attempting to connect with Server... Sending >> ", synMessage, "\r\n" );
    if( !TextProtocol::Socket::Send( m_Client, synMessage ) )
@@ -266,7 +306,11 @@ void CurlAppController::establishConnection()
 
    debugPrint( "Waiting for SYN_ACK...", "\r\n" );
 
-   auto synackMessage = TextProtocol::Socket::Receive( m_Client );
+   auto synackMessage = receiveWithin( RESPONSE_TIMEOUT );
+
+   // Refusals of a failed resumption may still be on their way
+   while( synackMessage.has_value() && synackMessage->m_PacketType == TextProtocol::PacketType::NACK )
+      synackMessage = receiveWithin( RESPONSE_TIMEOUT );
 
    if( !synackMessage.has_value() )
    {
@@ -281,7 +325,13 @@ void CurlAppController::establishConnection()
       throw std::runtime_error( "SYN_ACK did not match expected seq num" );
    }
 
-   const TextProtocol::Message ackMessage( TextProtocol::PacketType::SYN_ACK, m_Expected++, serverIp, serverPort );
+   m_ServerWindow = synackMessage->m_Window;
+
+   // Next run can skip all of this
+   if( !synackMessage->m_Payload.empty() )
+      m_Sessions.Store( m_ServerIp, m_ServerPort, synackMessage->m_Payload );
+
+   const TextProtocol::Message ackMessage( TextProtocol::PacketType::SYN_ACK, m_Expected++, m_ServerIp, m_ServerPort );
 
    debugPrint( "Completing three-way hand shake... Sending >> ", ackMessage, "\r\n" );
    if( !TextProtocol::Socket::Send( m_Client, ackMessage ) )
@@ -294,7 +344,7 @@ void CurlAppController::establishConnection()
    if( m_bVerbose ) std::cout << "Successfully connected to server!" << std::endl;
 }
 
-void CurlAppController::sendHttpRequest()
+bool CurlAppController::sendHttpRequest()
 {
    debugPrint( "Building Request..." );
 
@@ -305,43 +355,100 @@ void CurlAppController::sendHttpRequest()
    }
    oReq.AppendMessageBody( m_sBody );
 
-   sockaddr_in sa{};
-   // store this IP address in sa:
-   inet_pton( AF_INET, m_Client.GetServerAddr().c_str(), &( sa.sin_addr ) );
-   const TextProtocol::IpV4Address serverIp{ sa.sin_addr.s_addr };
-   const TextProtocol::PortNumber serverPort{ 8080 };
+   TextProtocol::Sender oSender( m_Expected, m_ServerIp, m_ServerPort, oReq.GetWireFormat(), m_ServerWindow );
+   const auto transmit = [ this ]( const TextProtocol::Message& segment )
+   {
+      debugPrint( " Sending >> ", segment, "\r\n" );
+      return TextProtocol::Socket::Send( m_Client, segment );
+   };
+
+   debugPrint( " Sending ", oReq.GetRequestLine() );
+   while( !oSender.IsComplete() )
+   {
+      oSender.Poll( TextProtocol::Clock::now(), transmit );
+
+      if( oSender.HasFailed() )
+         throw std::runtime_error( "Failed to send HTTP request, server stopped acknowledging" );
+
+      auto ack = receiveWithin( oSender.NextTimeout() - TextProtocol::Clock::now() );
+      if( !ack.has_value() ) continue;
+
+      if( ack->m_PacketType == TextProtocol::PacketType::NACK )
+      {
+         if( m_bResuming ) return false;
+         continue; // leftover from the refused resumption
+      }
+
+      oSender.OnAck( ack->AsView(), TextProtocol::Clock::now() );
+
+      if( ack->m_PacketType == TextProtocol::PacketType::DATA || ack->m_PacketType == TextProtocol::PacketType::FIN )
+      {
+         // The server only answers once it has the whole request, its acknowledgement rode along with the response
+         m_EarlyResponse = std::move( ack );
+         break;
+      }
+   }
 
-   TextProtocol::Message request( TextProtocol::PacketType::ACK, m_Expected++, serverIp, serverPort );
-   request.m_Payload = oReq.GetWireFormat();
+   debugPrint( "Request delivered, smoothed RTT is ", oSender.GetRttEstimator().Srtt().count(), "us\r\n" );
+   m_Expected = oSender.End();
+   return true;
+}
+
+std::optional<TextProtocol::Message> CurlAppController::receiveWithin( TextProtocol::Clock::duration timeout )
+{
+   const auto usec = std::max<long long>( 1000, std::chrono::duration_cast<std::chrono::microseconds>( timeout ).count() );
+   m_Client.SetReceiveTimeout( static_cast<int32_t>( usec / 1000000 ), static_cast<int32_t>( usec % 1000000 ) );
 
-   debugPrint( " Sending >> ", request, " for ", oReq.GetRequestLine(), "\r\n" );
-   if( !TextProtocol::Socket::Send( m_Client, request ) )
-      throw std::runtime_error( "Failed to send HTTP request" );
+   return TextProtocol::Socket::Receive( m_Client );
 }
 
 void CurlAppController::receiveHttpResponse()
 {
    debugPrint( "Receiving... " );
-   auto response = TextProtocol::Socket::Receive( m_Client );
-   if( response.has_value() )
-   {
-      HttpResponseParser oParser;
-      oParser.AppendResponseData( response->m_Payload );
-      auto httpResponse = oParser.GetHttpResponse();
 
-      debugPrint( *response, httpResponse.GetStatusLine(), "\r\n\r\nHere's the response!" );
+   TextProtocol::Receiver oReceiver( m_Expected, m_ServerIp, m_ServerPort );
+   std::optional<TextProtocol::Message> segment = std::move( m_EarlyResponse );
 
-      if( m_bVerbose )
+   while( !oReceiver.IsComplete() )
+   {
+      const auto now = TextProtocol::Clock::now();
+      auto ack = oReceiver.Poll( now );
+
+      if( !segment.has_value() && !ack.has_value() )
       {
-         std::cout << httpResponse.GetWireFormat();
+         const auto deadline = oReceiver.NextAckDeadline().value_or( now + RESPONSE_TIMEOUT );
+         segment = receiveWithin( deadline - now );
+
+         if( !segment.has_value() && !oReceiver.NextAckDeadline().has_value() )
+         {
+            debugPrint( "Received failed due to: ", m_Client.DescribeError() );
+            return;
+         }
       }
-      else
+
+      if( segment.has_value() )
       {
-         std::cout << httpResponse.GetBody();
+         debugPrint( "Obtained >> ", *segment, "\r\n" );
+         ack = oReceiver.OnData( segment->AsView(), TextProtocol::Clock::now() );
+         segment.reset();
       }
+
+      if( ack.has_value() )
+         TextProtocol::Socket::Send( m_Client, *ack );
+   }
+
+   HttpResponseParser oParser;
+   oParser.AppendResponseData( oReceiver.GetData() );
+   auto httpResponse = oParser.GetHttpResponse();
+
+   debugPrint( httpResponse.GetStatusLine(), "\r\n\r\nHere's the response!" );
+
+   if( m_bVerbose )
+   {
+      std::cout << httpResponse.GetWireFormat();
    }
    else
    {
-      debugPrint( "Received failed due to: ", m_Client.DescribeError() );
+      std::cout << httpResponse.GetBody();
    }
 }
@@ -33,7 +33,10 @@ SOFTWARE.
 #include "../../../Curl/src/Href.h"
 #include "ActiveSocket.h"
 #include "Message.h"
+#include "Transport.h"
+#include "SessionCache.h"
 #include <iostream>
+#include <optional>
 
 class CurlAppController final
 {
@@ -86,12 +89,26 @@ private:
 
    CActiveSocket m_Client;
    TextProtocol::SequenceNumber m_Expected{ 0 }; // by this side
+   TextProtocol::IpV4Address m_ServerIp{ 0 };
+   TextProtocol::PortNumber m_ServerPort{ 8080 };
+   TextProtocol::WindowSize m_ServerWindow = TextProtocol::Message::DEFAULT_WINDOW;
+   std::optional<TextProtocol::Message> m_EarlyResponse;
+   SessionCache m_Sessions;
+   bool m_bResuming = false; // request was sent without a handshake, server may still refuse it
+
+   static constexpr auto RESPONSE_TIMEOUT = std::chrono::seconds( 5 );
 
    void validateCommand() const;
 
+   void connectToRouter();
+
+   bool resumeSession();
+
    void establishConnection();
 
-   void sendHttpRequest();
+   bool sendHttpRequest();
 
    void receiveHttpResponse();
+
+   std::optional<TextProtocol::Message> receiveWithin( TextProtocol::Clock::duration timeout );
 };
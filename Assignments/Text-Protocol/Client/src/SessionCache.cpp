@@ -0,0 +1,126 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Chris McArthur, prince.chrismc(at)gmail(dot)com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "SessionCache.h"
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+static std::string toHex( const std::string& bytes )
+{
+   static constexpr char DIGITS[] = "0123456789abcdef";
+
+   std::string hex;
+   hex.reserve( bytes.size() * 2 );
+   for( const unsigned char byte : bytes )
+   {
+      hex.push_back( DIGITS[ byte >> 4 ] );
+      hex.push_back( DIGITS[ byte & 0x0f ] );
+   }
+
+   return hex;
+}
+
+static std::optional<std::string> fromHex( const std::string& hex )
+{
+   if( hex.size() % 2 != 0 ) return std::nullopt;
+
+   std::string bytes;
+   bytes.reserve( hex.size() / 2 );
+   for( size_t i = 0; i < hex.size(); i += 2 )
+   {
+      try
+      {
+         size_t read = 0;
+         bytes.push_back( static_cast<char>( std::stoul( hex.substr( i, 2 ), &read, 16 ) ) );
+         if( read != 2 ) return std::nullopt;
+      }
+      catch( const std::exception& )
+      {
+         return std::nullopt;
+      }
+   }
+
+   return bytes;
+}
+
+SessionCache::SessionCache( std::string path ) : m_Path( std::move( path ) )
+{
+   std::ifstream file( m_Path );
+
+   std::string line;
+   while( std::getline( file, line ) )
+   {
+      std::istringstream fields( line );
+      uint32_t ip = 0;
+      unsigned short port = 0;
+      std::string hex;
+
+      if( !( fields >> ip >> port >> hex ) ) continue; // someone edited the file, skip whatever is broken
+
+      if( auto token = fromHex( hex ); token.has_value() )
+         m_Tokens[ { TextProtocol::IpV4Address{ ip }, TextProtocol::PortNumber{ port } } ] = std::move( *token );
+   }
+}
+
+std::optional<std::string> SessionCache::Find( TextProtocol::IpV4Address ip, TextProtocol::PortNumber port ) const
+{
+   const auto itor = m_Tokens.find( { ip, port } );
+   if( itor == m_Tokens.end() ) return std::nullopt;
+
+   return itor->second;
+}
+
+void SessionCache::Store( TextProtocol::IpV4Address ip, TextProtocol::PortNumber port, std::string token )
+{
+   m_Tokens[ { ip, port } ] = std::move( token );
+   save();
+}
+
+void SessionCache::Forget( TextProtocol::IpV4Address ip, TextProtocol::PortNumber port )
+{
+   if( m_Tokens.erase( { ip, port } ) > 0 ) save();
+}
+
+std::string SessionCache::DefaultPath()
+{
+#ifdef _WIN32
+   const char* home = std::getenv( "USERPROFILE" );
+#else
+   const char* home = std::getenv( "HOME" );
+#endif
+
+   return std::string( home != nullptr ? home : "." ) + "/.httpc_sessions";
+}
+
+void SessionCache::save() const
+{
+   // Best effort, without a cache the next run just does the full handshake
+   std::ofstream file( m_Path, std::ios::out | std::ios::trunc );
+
+   for( const auto& [ server, token ] : m_Tokens )
+      file << static_cast<uint32_t>( server.first ) << " " << static_cast<unsigned short>( server.second ) << " " << toHex( token ) << "\n";
+}
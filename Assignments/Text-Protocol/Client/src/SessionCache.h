@@ -0,0 +1,56 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Chris McArthur, prince.chrismc(at)gmail(dot)com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#pragma once
+
+#include "Message.h"
+#include <map>
+#include <optional>
+#include <string>
+
+//
+// Resumption tokens handed out by servers, kept on disk so the next run can skip the handshake. One line per server
+// with its address, port and the token in hex.
+//
+class SessionCache
+{
+public:
+   explicit SessionCache( std::string path = DefaultPath() );
+
+   std::optional<std::string> Find( TextProtocol::IpV4Address ip, TextProtocol::PortNumber port ) const;
+   void Store( TextProtocol::IpV4Address ip, TextProtocol::PortNumber port, std::string token );
+   void Forget( TextProtocol::IpV4Address ip, TextProtocol::PortNumber port );
+
+   static std::string DefaultPath(); // $HOME/.httpc_sessions
+
+private:
+   using ServerAddress = std::pair<TextProtocol::IpV4Address, TextProtocol::PortNumber>;
+
+   std::string m_Path;
+   std::map<ServerAddress, std::string> m_Tokens;
+
+   void save() const;
+};
@@ -0,0 +1,295 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Chris McArthur, prince.chrismc(at)gmail(dot)com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "AppController.h"
+#include "Router.h"
+#include <algorithm>
+#include <cstring>
+#include <future>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+#ifdef _WIN32
+#include <Ws2tcpip.h>
+using socklen_t = int;
+#else
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#endif
+
+using namespace std::chrono_literals;
+
+AppController::AppController( int argc, char** argv ) :
+   m_CliParser( argc, argv ),
+   m_Verbose( false ),
+   m_Port( TextProtocol::Router::PORT ),
+   m_DropRate( 0.0 ),
+   m_ReorderRate( 0.0 ),
+   m_MinDelay( 0 ),
+   m_MaxDelay( 0 ),
+   m_Distribution( DelayDistribution::Uniform ),
+   m_Bandwidth( 0 ),
+   m_QueueLimit( 256 * 1024 ),
+   m_Seed( std::random_device{}() ),
+   m_Socket( CSimpleSocket::SocketTypeUdp ),
+   m_Buffers( POOL_SIZE ),
+   m_Lengths( POOL_SIZE )
+{
+   readCommandLineArgs();
+
+   m_FreeSlots.reserve( POOL_SIZE );
+   for( size_t slot = 0; slot < POOL_SIZE; slot++ ) m_FreeSlots.push_back( slot );
+}
+
+void AppController::Run()
+{
+   if( !m_Socket.Listen( TextProtocol::Router::IP_ADDR, m_Port ) )
+      throw std::runtime_error( "Failed to listen on port" );
+
+   std::cout << "Router listening on " << TextProtocol::Router::IP_ADDR << ":" << m_Port << " with seed " << m_Seed << std::endl;
+
+   std::promise<void> exitSignal;
+   std::shared_future<void> exitEvent = exitSignal.get_future();
+
+   std::thread oRelay( [ this, exitEvent ]()
+   {
+      const auto socket = m_Socket.GetSocketDescriptor();
+      std::mt19937 engine( m_Seed );
+      std::bernoulli_distribution shouldDrop( m_DropRate );
+      std::bernoulli_distribution shouldReorder( m_ReorderRate );
+      std::array<char, TextProtocol::Message::MAX_MESSAGE_SIZE> overflow;
+      auto nextReport = Clock::now() + 1s;
+
+      while( exitEvent.wait_for( 0ms ) == std::future_status::timeout )
+      {
+         auto now = Clock::now();
+         forwardDuePackets( now );
+
+         if( m_Verbose && now >= nextReport )
+         {
+            printStatistics();
+            nextReport = now + 1s;
+         }
+
+         // Block on the socket only until the next packet is due to leave
+         const auto wait = m_InFlight.empty() ? 100ms :
+            std::clamp( std::chrono::duration_cast<std::chrono::microseconds>( m_InFlight.top().m_Release - now ), 100us,
+                        std::chrono::microseconds( 100ms ) );
+         m_Socket.SetReceiveTimeout( 0, static_cast<int32_t>( wait.count() ) );
+
+         const bool bHasRoom = !m_FreeSlots.empty();
+         const auto slot = bHasRoom ? m_FreeSlots.back() : 0;
+         auto buffer = bHasRoom ? m_Buffers[ slot ].data() : overflow.data();
+
+         sockaddr_in source{};
+         socklen_t sourceLength = sizeof( source );
+         const auto bytesObtained = recvfrom( socket, buffer, TextProtocol::Message::MAX_MESSAGE_SIZE, 0,
+                                              reinterpret_cast<sockaddr*>( &source ), &sourceLength );
+
+         if( bytesObtained < static_cast<decltype( bytesObtained )>( TextProtocol::Message::ROUTER_HEADER_SIZE ) ) continue;
+
+         now = Clock::now();
+         m_Stats.m_Received += 1;
+
+         if( !bHasRoom )
+         {
+            m_Stats.m_Overflowed += 1;
+            continue;
+         }
+
+         if( shouldDrop( engine ) )
+         {
+            m_Stats.m_Dropped += 1;
+            continue;
+         }
+
+         // Serialize on the link, whatever can not fit in the queue is tail dropped
+         auto departure = std::max( now, m_LinkFreeAt );
+         if( m_Bandwidth > 0 )
+         {
+            const auto backlog = std::chrono::duration<double>( departure - now ).count() * m_Bandwidth;
+            if( backlog > m_QueueLimit )
+            {
+               m_Stats.m_Overflowed += 1;
+               continue;
+            }
+
+            departure += std::chrono::duration_cast<Clock::duration>( std::chrono::duration<double>( static_cast<double>( bytesObtained ) / m_Bandwidth ) );
+            m_LinkFreeAt = departure;
+         }
+
+         auto release = departure + sampleDelay( engine );
+         if( shouldReorder( engine ) )
+         {
+            release += std::max<std::chrono::microseconds>( m_MaxDelay, 10ms ); // held back long enough to be overtaken
+            m_Stats.m_Reordered += 1;
+         }
+
+         // Swap the destination embedded in the header for the source so the receiver knows who to reply to
+         Packet packet{ release, slot, {} };
+         packet.m_Destination.sin_family = AF_INET;
+         std::memcpy( &packet.m_Destination.sin_addr, buffer + IP_OFFSET, sizeof( packet.m_Destination.sin_addr ) );
+         std::memcpy( &packet.m_Destination.sin_port, buffer + PORT_OFFSET, sizeof( packet.m_Destination.sin_port ) );
+         std::memcpy( buffer + IP_OFFSET, &source.sin_addr, sizeof( source.sin_addr ) );
+         std::memcpy( buffer + PORT_OFFSET, &source.sin_port, sizeof( source.sin_port ) );
+
+         m_FreeSlots.pop_back();
+         m_Lengths[ slot ] = static_cast<size_t>( bytesObtained );
+         m_InFlight.push( packet );
+      }
+   } );
+
+   std::cout << "Press 'enter' to close." << std::endl;
+   getchar();
+
+   exitSignal.set_value();
+   oRelay.join();
+
+   printStatistics();
+   m_Socket.Close();
+}
+
+void AppController::forwardDuePackets( Clock::time_point now )
+{
+   while( !m_InFlight.empty() && m_InFlight.top().m_Release <= now )
+   {
+      const auto packet = m_InFlight.top();
+      m_InFlight.pop();
+
+      sendto( m_Socket.GetSocketDescriptor(), m_Buffers[ packet.m_Slot ].data(), static_cast<int>( m_Lengths[ packet.m_Slot ] ), 0,
+              reinterpret_cast<const sockaddr*>( &packet.m_Destination ), sizeof( packet.m_Destination ) );
+
+      m_Stats.m_Forwarded += 1;
+      m_FreeSlots.push_back( packet.m_Slot );
+   }
+}
+
+std::chrono::microseconds AppController::sampleDelay( std::mt19937& engine ) const
+{
+   if( m_MaxDelay <= m_MinDelay ) return m_MinDelay;
+
+   const double min = static_cast<double>( m_MinDelay.count() );
+   const double max = static_cast<double>( m_MaxDelay.count() );
+
+   double delay = min;
+   switch( m_Distribution )
+   {
+   case DelayDistribution::Uniform:
+      delay = std::uniform_real_distribution<double>( min, max )( engine );
+      break;
+   case DelayDistribution::Normal:
+      delay = std::normal_distribution<double>( ( min + max ) / 2.0, ( max - min ) / 6.0 )( engine );
+      break;
+   case DelayDistribution::Exponential:
+      delay = min + std::exponential_distribution<double>( 2.0 / ( max - min ) )( engine );
+      break;
+   }
+
+   return std::chrono::microseconds( static_cast<long long>( std::clamp( delay, min, max ) ) );
+}
+
+void AppController::printStatistics() const
+{
+   std::cout << "Router >> received " << m_Stats.m_Received << " forwarded " << m_Stats.m_Forwarded << " dropped " << m_Stats.m_Dropped
+      << " overflowed " << m_Stats.m_Overflowed << " reordered " << m_Stats.m_Reordered << " in flight " << m_InFlight.size() << std::endl;
+}
+
+/*
+General Usage
+   router help
+router is a lossy UDP relay for the Text-Protocol.
+usage:
+   router [-v] [--port PORT] [--drop-rate RATE] [--min-delay MS] [--max-delay MS] [--delay-dist uniform|normal|exp]
+          [--reorder-rate RATE] [--bandwidth BYTES-PER-SEC] [--queue BYTES] [--seed SEED]
+ */
+void AppController::printGeneralUsage()
+{
+   std::cout << "General Usage\r\n   router help\r\nrouter is a lossy UDP relay for the Text-Protocol.\r\nUsage:\r\n";
+   std::cout << "   router [-v] [--port PORT] [--drop-rate RATE] [--min-delay MS] [--max-delay MS] [--delay-dist uniform|normal|exp]\r\n";
+   std::cout << "          [--reorder-rate RATE] [--bandwidth BYTES-PER-SEC] [--queue BYTES] [--seed SEED]\r\n";
+   std::cout << "-v               Prints statistics every second.\r\n--port           Port to listen on. Default is 36578.\r\n";
+   std::cout << "--drop-rate      Probability between 0 and 1 that a packet is lost. Default is 0.\r\n";
+   std::cout << "--min-delay      Minimum one way delay in milliseconds. Default is 0.\r\n";
+   std::cout << "--max-delay      Maximum one way delay in milliseconds. Default is 0.\r\n";
+   std::cout << "--delay-dist     How delays are spread between the min and max. Default is uniform.\r\n";
+   std::cout << "--reorder-rate   Probability between 0 and 1 that a packet is held back and overtaken. Default is 0.\r\n";
+   std::cout << "--bandwidth      Link capacity in bytes per second, 0 means unlimited. Default is 0.\r\n";
+   std::cout << "--queue          Bytes that can wait for the link before being dropped. Default is 262144.\r\n";
+   std::cout << "--seed           Seed for the random generator, to reproduce a run." << std::endl;
+}
+
+template<typename Value>
+Value AppController::readOption( const char* name, Value defaultValue ) const
+{
+   if( !m_CliParser.DoesSwitchExists( name ) ) return defaultValue;
+
+   auto itor = m_CliParser.find( name );
+   if( ++itor == m_CliParser.cend() )
+   {
+      printGeneralUsage();
+      throw std::logic_error( std::string( "Missing value for " ) + name );
+   }
+
+   Value value{};
+   std::istringstream reader( *itor );
+   if( !( reader >> value ) )
+   {
+      printGeneralUsage();
+      throw std::logic_error( std::string( "Invalid value for " ) + name );
+   }
+
+   return value;
+}
+
+void AppController::readCommandLineArgs()
+{
+   if( m_CliParser.DoesSwitchExists( "help" ) )
+   {
+      printGeneralUsage();
+      throw std::logic_error( "Nothing to route" );
+   }
+
+   m_Verbose = m_CliParser.DoesSwitchExists( "-v" );
+   m_Port = readOption<unsigned short>( "--port", m_Port );
+   m_DropRate = std::clamp( readOption( "--drop-rate", m_DropRate ), 0.0, 1.0 );
+   m_ReorderRate = std::clamp( readOption( "--reorder-rate", m_ReorderRate ), 0.0, 1.0 );
+   m_MinDelay = std::chrono::milliseconds( readOption<long long>( "--min-delay", 0 ) );
+   m_MaxDelay = std::max( m_MinDelay, std::chrono::microseconds( std::chrono::milliseconds( readOption<long long>( "--max-delay", 0 ) ) ) );
+   m_Bandwidth = readOption( "--bandwidth", m_Bandwidth );
+   m_QueueLimit = readOption( "--queue", m_QueueLimit );
+   m_Seed = readOption( "--seed", m_Seed );
+
+   const auto distribution = readOption<std::string>( "--delay-dist", "uniform" );
+   if( distribution == "uniform" ) m_Distribution = DelayDistribution::Uniform;
+   else if( distribution == "normal" ) m_Distribution = DelayDistribution::Normal;
+   else if( distribution == "exp" ) m_Distribution = DelayDistribution::Exponential;
+   else
+   {
+      printGeneralUsage();
+      throw std::logic_error( "Unknown delay distribution!" );
+   }
+}
@@ -0,0 +1,107 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Chris McArthur, prince.chrismc(at)gmail(dot)com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#pragma once
+
+#include "CliParser.h"
+#include "PassiveSocket.h"
+#include "Message.h"
+#include <array>
+#include <chrono>
+#include <functional>
+#include <queue>
+#include <random>
+#include <vector>
+
+//
+// Stand-in for the course's UDP router. Messages are forwarded to the peer embedded in their header, which is then
+// rewritten with the sender's address so the receiver knows where to reply. On the way the link can drop, delay,
+// reorder and rate limit them to reproduce a realistic network on a single machine.
+//
+class AppController
+{
+public:
+   AppController( int argc, char** argv );
+
+   void Run();
+
+private:
+   using Clock = std::chrono::steady_clock;
+
+   enum class DelayDistribution { Uniform, Normal, Exponential };
+
+   CommandLineParser m_CliParser;
+
+   bool m_Verbose;
+   unsigned short m_Port;
+   double m_DropRate;
+   double m_ReorderRate;
+   std::chrono::microseconds m_MinDelay;
+   std::chrono::microseconds m_MaxDelay;
+   DelayDistribution m_Distribution;
+   size_t m_Bandwidth;  // bytes per second, 0 for unlimited
+   size_t m_QueueLimit; // bytes waiting on the link before tail drop
+   unsigned m_Seed;
+
+   CPassiveSocket m_Socket;
+
+   struct Packet
+   {
+      Clock::time_point m_Release;
+      size_t m_Slot;
+      sockaddr_in m_Destination;
+
+      bool operator>( const Packet& other ) const { return m_Release > other.m_Release; }
+   };
+
+   struct Statistics
+   {
+      size_t m_Received = 0;
+      size_t m_Forwarded = 0;
+      size_t m_Dropped = 0;
+      size_t m_Overflowed = 0;
+      size_t m_Reordered = 0;
+   };
+
+   static void printGeneralUsage();
+   void readCommandLineArgs();
+   template<typename Value> Value readOption( const char* name, Value defaultValue ) const;
+
+   std::chrono::microseconds sampleDelay( std::mt19937& engine ) const;
+   void forwardDuePackets( Clock::time_point now );
+   void printStatistics() const;
+
+   std::vector<std::array<char, TextProtocol::Message::MAX_MESSAGE_SIZE>> m_Buffers;
+   std::vector<size_t> m_Lengths;
+   std::vector<size_t> m_FreeSlots;
+   std::priority_queue<Packet, std::vector<Packet>, std::greater<Packet>> m_InFlight;
+   Clock::time_point m_LinkFreeAt;
+   Statistics m_Stats;
+
+   static constexpr size_t POOL_SIZE = 4096;
+   static constexpr size_t IP_OFFSET = sizeof( TextProtocol::PacketType ) + sizeof( TextProtocol::SequenceNumber );
+   static constexpr size_t PORT_OFFSET = IP_OFFSET + sizeof( TextProtocol::IpV4Address );
+};
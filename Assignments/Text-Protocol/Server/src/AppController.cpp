@@ -27,8 +27,10 @@ SOFTWARE.
 #include "AppController.h"
 #include "Message.h"
 #include "Socket.h"
+#include "PacketRing.h"
+#include "Transport.h"
 #include "HttpRequest.h"
-#include "FileServlet.h"
+#include "AccessLog.h"
 #include <iostream>
 #include <thread>
 #include <future>
@@ -36,6 +38,17 @@ SOFTWARE.
 using namespace std::chrono_literals;
 using TextProtocol::PacketType;
 
+static void logPacket( const char* event, const TextProtocol::MessageView& message )
+{
+   if( !Http::AccessLog::IsOpen() ) return;
+
+   const auto uIp = static_cast<uint32_t>( message.m_DstIp );
+   Http::AccessLog::Write( event, "type=%s seq=%u peer=%u.%u.%u.%u:%u win=%u ack=%u sack=%08x bytes=%zu", TextProtocol::ToString( message.m_PacketType ),
+                           static_cast<uint32_t>( message.m_SeqNum ), uIp & 0xff, ( uIp >> 8 ) & 0xff, ( uIp >> 16 ) & 0xff, uIp >> 24,
+                           static_cast<unsigned>( message.m_DstPort ), static_cast<unsigned>( message.m_Window ),
+                           static_cast<uint32_t>( message.m_AckNum ), static_cast<uint32_t>( message.m_SackBits ), message.m_Payload.size() );
+}
+
 AppController::AppController( int argc, char** argv ) :
    m_CliParser( argc, argv ),
    m_Verbose( false ),
@@ -51,69 +64,248 @@ void AppController::Run()
    if( !m_Socket.Listen( "127.0.0.1", m_Port ) )
       throw std::runtime_error( "Failed to listen on port" );
 
+   // Wake up regularly so the receiving thread notices when it's time to exit
+   m_Socket.SetReceiveTimeout( 0, 10000 );
+
    std::promise<void> exitSignal;
-   auto oExitEvent = exitSignal.get_future();
+   std::shared_future<void> exitEvent = exitSignal.get_future();
+
+   auto pRing = std::make_unique<TextProtocol::PacketRing<>>();
 
-   std::thread( [ this, exitEvent = std::move( oExitEvent ) ]()
+   // Drains the socket as fast as possible so bursts land in the ring rather than overflowing the kernel buffer
+   std::thread oReceiver( [ this, exitEvent, &ring = *pRing ]()
+   {
+      TextProtocol::PacketSlot overflow;
+
+      while( exitEvent.wait_for( 0ms ) == std::future_status::timeout )
+      {
+         auto pSlot = ring.Claim();
+         if( pSlot == nullptr )
+         {
+            // Protocol thread is behind, drop the datagram and let the sender retransmit it
+            if( TextProtocol::Socket::Receive( m_Socket, overflow ) )
+               logPacket( "drop", overflow.View() );
+
+            continue;
+         }
+
+         if( TextProtocol::Socket::Receive( m_Socket, *pSlot ) )
+            ring.Publish();
+      }
+   } );
+
+   std::thread oProtocol( [ this, exitEvent, &ring = *pRing ]()
    {
       FileServlet oFileExplorer( m_RootDir );
+      std::map<PeerAddress, ClientConnection> connections;
 
-      while( exitEvent.wait_for( 10ms ) == std::future_status::timeout )
+      while( exitEvent.wait_for( 0ms ) == std::future_status::timeout )
       {
-         auto input = TextProtocol::Socket::Receive( m_Socket );
+         if( auto pSlot = ring.Peek() )
+         {
+            logPacket( "recv", pSlot->View() );
 
-         if( input.has_value() )
+            handlePacket( *pSlot, connections, oFileExplorer );
+            ring.Release(); // done with the view, the slot can be reused
+         }
+         else
          {
-            std::cout << "Server >> obtained " << m_Socket.GetBytesReceived() << " containing the following: " << *input
-               << " from [ " << m_Socket.GetClientAddr() << ":" << m_Socket.GetClientPort() << " ]" << std::endl;
+            exitEvent.wait_for( 1ms );
+         }
 
-            if( input->m_PacketType == PacketType::SYN )
+         // Keep every response flowing, retransmitting whatever timed out, and flush delayed acknowledgements
+         const auto now = TextProtocol::Clock::now();
+         for( auto itor = connections.begin(); itor != connections.end(); /* no itor */ )
+         {
+            const auto transmit = [ this, &router = itor->second.m_Router ]( const TextProtocol::Message& segment )
             {
-               input->m_PacketType = PacketType::SYN_ACK;
-            }
-            else if( input->m_PacketType == PacketType::SYN_ACK )
+               logPacket( "send", segment.AsView() );
+               return TextProtocol::Socket::Send( m_Socket, segment, router );
+            };
+
+            if( auto& request = itor->second.m_Request; request.has_value() )
             {
-               std::cout << "New client connection has been established!" << std::endl;
-               continue;
+               if( const auto ack = request->Poll( now ); ack.has_value() )
+                  transmit( *ack );
             }
-            else if( input->m_PacketType == PacketType::ACK )
-            {
-               HttpResponse response( Http::Version::v10, Http::Status::BadRequest, "BAD REQUEST" );
-               HttpRequestParser parser;
-               parser.AppendRequestData( input->m_Payload );
 
-               try
-               {
-                  auto req = parser.GetHttpRequest();
+            auto& response = itor->second.m_Response;
+            if( response.has_value() )
+            {
+               response->Poll( now, transmit );
 
-                  if( req.IsValid() )
-                  {
-                     response = HttpResponse( Http::Version::v10, Http::Status::InternalServerError, "INTERNAL SERVER ERROR" );
-                     response = oFileExplorer.HandleRequest( req );
-                  }
-               }
-               catch( const std::exception& e )
+               if( response->IsComplete() || response->HasFailed() )
                {
-                  std::cout << "Error handling request: " << e.what() << std::endl;
+                  itor = connections.erase( itor );
+                  continue;
                }
-
-               input->m_Payload = response.GetWireFormat().substr( 0, TextProtocol::Message::MAX_PAYLOAD_LENGTH );
             }
 
-            ++input->m_SeqNum;
-            std::cout << "Server >> Sending... " << *input << std::endl;
-            TextProtocol::Socket::Send( m_Socket, *input );
+            ++itor;
          }
       }
+   } );
 
-      m_Socket.Close();
-   }
-   ).detach();
+   if( m_Verbose || m_CliParser.DoesSwitchExists( "-l" ) )
+      Http::AccessLog::Open( m_AccessLog );
 
    std::cout << "Press 'enter' to close." << std::endl;
    getchar();
 
    exitSignal.set_value();
+
+   oReceiver.join();
+   oProtocol.join();
+
+   Http::AccessLog::Close();
+
+   m_Socket.Close();
+}
+
+// Answering it again changes nothing, the only kind of request taken without a handshake
+static bool isSafeRequest( std::string_view rawRequest )
+{
+   const std::string_view sMethod = rawRequest.substr( 0, rawRequest.find( ' ' ) );
+   return sMethod == "GET" || sMethod == "HEAD";
+}
+
+void AppController::handlePacket( const TextProtocol::PacketSlot& packet, std::map<PeerAddress, ClientConnection>& connections,
+                                  const FileServlet& servlet )
+{
+   const TextProtocol::MessageView input = packet.View();
+   const PeerAddress peer{ input.m_DstIp, input.m_DstPort };
+
+   switch( input.m_PacketType )
+   {
+   case PacketType::SYN:
+   {
+      // Client sends its SYN_ACK with the next sequence number, the request follows right after
+      auto& connection = connections[ peer ];
+      connection.m_Response.reset();
+      connection.m_Request.emplace( TextProtocol::SequenceNumber{ static_cast<uint32_t>( input.m_SeqNum ) + 2 }, input.m_DstIp, input.m_DstPort );
+      connection.m_Router = packet.m_From;
+      connection.m_bEarly = false;
+
+      // Hand out a token so the client's next request can skip all of this
+      TextProtocol::Message reply( PacketType::SYN_ACK, input.m_SeqNum, input.m_DstIp, input.m_DstPort );
+      reply.m_Payload = m_Tokens.Issue( input.m_DstIp );
+      ++reply.m_SeqNum;
+
+      send( reply, packet.m_From );
+      break;
+   }
+   case PacketType::SYN_ACK:
+      logPacket( "connect", input );
+      break;
+
+   case PacketType::RESUME:
+   {
+      if( !m_Tokens.Validate( input.m_Payload, input.m_DstIp ) )
+      {
+         logPacket( "refuse_resume", input );
+         sendNack( input, packet.m_From );
+         break;
+      }
+
+      // Resume takes the place of the client's SYN_ACK, the request is right behind it
+      auto& connection = connections[ peer ];
+      connection.m_Response.reset();
+      connection.m_Request.emplace( TextProtocol::SequenceNumber{ static_cast<uint32_t>( input.m_SeqNum ) + 1 }, input.m_DstIp, input.m_DstPort );
+      connection.m_Router = packet.m_From;
+      connection.m_bEarly = true;
+
+      logPacket( "resume", input );
+      break;
+   }
+
+   case PacketType::DATA:
+   case PacketType::FIN:
+   {
+      const auto itor = connections.find( peer );
+      if( itor == connections.end() || !itor->second.m_Request.has_value() )
+      {
+         // Never shook hands, or the resume that should have come first got lost
+         sendNack( input, packet.m_From );
+         break;
+      }
+
+      itor->second.m_Router = packet.m_From;
+
+      auto& request = *itor->second.m_Request;
+      const auto ack = request.OnData( input, TextProtocol::Clock::now() );
+
+      if( request.IsComplete() && !itor->second.m_Response.has_value() && itor->second.m_bEarly && !isSafeRequest( request.GetData() ) )
+      {
+         // Anyone who saw the token and the request can send them again, the client has to shake hands for this one
+         logPacket( "refuse_early", input );
+         sendNack( input, packet.m_From );
+         connections.erase( itor );
+      }
+      else if( request.IsComplete() && !itor->second.m_Response.has_value() )
+      {
+         // The first segment of the response goes out on the next poll and carries the acknowledgement with it
+         itor->second.m_Response.emplace( request.End(), input.m_DstIp, input.m_DstPort, handleHttpRequest( request.GetData(), servlet ),
+                                          input.m_Window, &request );
+      }
+      else if( ack.has_value() )
+      {
+         send( *ack, packet.m_From );
+      }
+      break;
+   }
+   case PacketType::ACK:
+   {
+      const auto itor = connections.find( peer );
+      if( itor != connections.end() && itor->second.m_Response.has_value() )
+      {
+         itor->second.m_Router = packet.m_From;
+         itor->second.m_Response->OnAck( input, TextProtocol::Clock::now() );
+      }
+      break;
+   }
+   default:
+      break;
+   }
+}
+
+// Only ever called from the protocol thread, the receiving one never sends
+void AppController::send( const TextProtocol::Message& message, const sockaddr_in& to )
+{
+   logPacket( "send", message.AsView() );
+   TextProtocol::Socket::Send( m_Socket, message, to );
+}
+
+void AppController::sendNack( const TextProtocol::MessageView& input, const sockaddr_in& to )
+{
+   TextProtocol::Message reply( PacketType::NACK, input.m_SeqNum, input.m_DstIp, input.m_DstPort );
+   reply.m_Payload.clear();
+
+   send( reply, to );
+}
+
+std::string AppController::handleHttpRequest( const std::string& rawRequest, const FileServlet& servlet )
+{
+   HttpResponse response( Http::Version::v10, Http::Status::BadRequest, "BAD REQUEST" );
+   HttpRequestParser parser;
+   parser.AppendRequestData( rawRequest );
+
+   try
+   {
+      auto req = parser.GetHttpRequest();
+
+      if( req.IsValid() )
+      {
+         response = HttpResponse( Http::Version::v10, Http::Status::InternalServerError, "INTERNAL SERVER ERROR" );
+         response = servlet.HandleRequest( req );
+      }
+   }
+   catch( const std::exception& e )
+   {
+      char szWhat[ Http::AccessLog::RECORD_SIZE ];
+      Http::AccessLog::Write( "error", "what=\"%s\"", Http::AccessLog::Escape( e.what(), szWhat, sizeof( szWhat ) ) );
+   }
+
+   return response.GetWireFormat();
 }
 
 /*
@@ -121,15 +313,19 @@ General Usage
    httpfs help
 httpfs is a simple HTTP based file server.
 usage:
-   httpfs [-v] [-p PORT] [-d PATH-TO-DIR]
+   httpfs [-v] [-p PORT] [-l LOG-PATH] [-r RATE] [-d PATH-TO-DIR]
 -v Prints debugging messages.
 -p Specifies the port number that the server will listen and serve at. Default is 8080.
+-l Writes the packet log to this file rather than the standard output, logging even without -v.
+-r Keeps one packet log record out of every RATE. Default is 1, every packet is logged.
 -d Specifies the directory that the server will use to read/write requested files. Default is the current directory when launching the application.
  */
 void AppController::printGeneralUsage()
 {
-   std::cout << "General Usage\r\n   httpfs help\r\nhttpfs is a simple file server.\r\nUsage:\r\n   hhttpfs [-v] [-p PORT] [-d PATH-TO-DIR]\r\n";
+   std::cout << "General Usage\r\n   httpfs help\r\nhttpfs is a simple file server.\r\nUsage:\r\n   hhttpfs [-v] [-p PORT] [-l LOG-PATH] [-r RATE] [-d PATH-TO-DIR]\r\n";
    std::cout << "-v   Prints debugging messages.\r\n-p Specifies the port number that the server will listen and serve at. Default is 8080.\r\n";
+   std::cout << "-l Writes the packet log to this file rather than the standard output, logging even without -v.\r\n";
+   std::cout << "-r Keeps one packet log record out of every RATE. Default is 1, every packet is logged.\r\n";
    std::cout << "-d Specifies the directory that the server will use to read/write requested files. Default is the current directory when launching the application.\r\n" << std::endl;
 }
 
@@ -150,6 +346,33 @@ void AppController::readCommandLineArgs()
       }
    }
 
+   if( m_CliParser.DoesSwitchExists( "-l" ) )
+   {
+      try
+      {
+         m_AccessLog.m_sPath = *++m_CliParser.find( "-l" );
+      }
+      catch( ... )
+      {
+         printGeneralUsage();
+         throw std::logic_error( "Incorrectly specified packet log!" );
+      }
+   }
+
+   if( m_CliParser.DoesSwitchExists( "-r" ) )
+   {
+      try
+      {
+         m_AccessLog.m_uSampleEvery = static_cast<unsigned>( std::stoul( *++m_CliParser.find( "-r" ) ) );
+         if( m_AccessLog.m_uSampleEvery == 0 ) throw std::invalid_argument( "zero" );
+      }
+      catch( ... )
+      {
+         printGeneralUsage();
+         throw std::logic_error( "Invalid packet log sampling rate specified!" );
+      }
+   }
+
    if( m_CliParser.DoesSwitchExists( "-d" ) )
    {
       try
@@ -28,6 +28,13 @@ SOFTWARE.
 
 #include "CliParser.h"
 #include "PassiveSocket.h"
+#include "FileServlet.h"
+#include "Transport.h"
+#include "PacketRing.h"
+#include "ResumptionTokens.h"
+#include "AccessLog.h"
+#include <map>
+#include <optional>
 
 class AppController
 {
@@ -42,8 +49,26 @@ private:
    bool m_Verbose;
    unsigned short m_Port;
    std::string m_RootDir;
+   Http::AccessLog::Options m_AccessLog;
 
    CPassiveSocket m_Socket;
+   TextProtocol::ResumptionTokens m_Tokens;
+
+   // Every client is seen through the router, its address is the one carried in the messages
+   using PeerAddress = std::pair<TextProtocol::IpV4Address, TextProtocol::PortNumber>;
+   struct ClientConnection
+   {
+      std::optional<TextProtocol::Receiver> m_Request;
+      std::optional<TextProtocol::Sender> m_Response;
+      sockaddr_in m_Router{}; // where its packets last came from, the protocol thread replies there
+      bool m_bEarly = false;  // resumed with a token, the request came without a handshake
+   };
+
+   void handlePacket( const TextProtocol::PacketSlot& packet, std::map<PeerAddress, ClientConnection>& connections,
+                      const FileServlet& servlet );
+   void send( const TextProtocol::Message& message, const sockaddr_in& to );
+   void sendNack( const TextProtocol::MessageView& input, const sockaddr_in& to );
+   static std::string handleHttpRequest( const std::string& rawRequest, const FileServlet& servlet );
 
    static void printGeneralUsage();
    void readCommandLineArgs();
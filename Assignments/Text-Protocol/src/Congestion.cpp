@@ -0,0 +1,72 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Chris McArthur, prince.chrismc(at)gmail(dot)com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "Congestion.h"
+#include <algorithm>
+
+void TextProtocol::RttEstimator::Sample( Duration rtt )
+{
+   if( !m_bHasSample )
+   {
+      m_Srtt = rtt;
+      m_RttVar = rtt / 2;
+      m_bHasSample = true;
+   }
+   else
+   {
+      // RTTVAR <- 3/4 * RTTVAR + 1/4 * | SRTT - R' | then SRTT <- 7/8 * SRTT + 1/8 * R'
+      const auto delta = ( m_Srtt > rtt ) ? m_Srtt - rtt : rtt - m_Srtt;
+      m_RttVar = ( 3 * m_RttVar + delta ) / 4;
+      m_Srtt = ( 7 * m_Srtt + rtt ) / 8;
+   }
+
+   m_Rto = std::clamp( m_Srtt + std::max( Duration{ 1000 }, 4 * m_RttVar ), MIN_RTO, MAX_RTO );
+}
+
+void TextProtocol::RttEstimator::Backoff()
+{
+   m_Rto = std::min( m_Rto * 2, MAX_RTO );
+}
+
+void TextProtocol::CongestionWindow::OnAck()
+{
+   if( m_Window < m_SlowStartThreshold )
+      m_Window += 1.0;            // slow start, doubles every round trip
+   else
+      m_Window += 1.0 / m_Window; // congestion avoidance, one packet every round trip
+}
+
+void TextProtocol::CongestionWindow::OnFastRetransmit()
+{
+   m_SlowStartThreshold = std::max( m_Window / 2.0, MIN_THRESHOLD );
+   m_Window = m_SlowStartThreshold;
+}
+
+void TextProtocol::CongestionWindow::OnTimeout()
+{
+   m_SlowStartThreshold = std::max( m_Window / 2.0, MIN_THRESHOLD );
+   m_Window = 1.0;
+}
@@ -0,0 +1,79 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Chris McArthur, prince.chrismc(at)gmail(dot)com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#pragma once
+
+#include <chrono>
+
+namespace TextProtocol
+{
+   //
+   // Round trip time estimation following Jacobson/Karels ( RFC 6298 ). Samples must only be taken from packets
+   // which were transmitted once ( Karn's algorithm ) so the estimate is never polluted by ambiguous ACKs.
+   //
+   class RttEstimator
+   {
+   public:
+      using Duration = std::chrono::microseconds;
+
+      void Sample( Duration rtt );
+      void Backoff(); // exponential backoff after a retransmission timeout
+
+      Duration Rto() const { return m_Rto; }
+      Duration Srtt() const { return m_Srtt; }
+
+      static constexpr Duration INITIAL_RTO = std::chrono::seconds( 1 );
+      static constexpr Duration MIN_RTO = std::chrono::milliseconds( 50 ); // loopback through the router, RFC says 1s
+      static constexpr Duration MAX_RTO = std::chrono::seconds( 60 );
+
+   private:
+      bool m_bHasSample = false;
+      Duration m_Srtt{ 0 };
+      Duration m_RttVar{ 0 };
+      Duration m_Rto = INITIAL_RTO;
+   };
+
+   //
+   // AIMD congestion window, counted in packets, with slow start. Grows by one packet per ACK until the slow start
+   // threshold, then by one packet per round trip. Loss halves the window.
+   //
+   class CongestionWindow
+   {
+   public:
+      size_t Size() const { return static_cast<size_t>( m_Window ); }
+
+      void OnAck();
+      void OnFastRetransmit(); // loss detected by the receiver's feedback, the pipe is still flowing
+      void OnTimeout();        // nothing came back, start over from one packet
+
+      static constexpr double INITIAL_WINDOW = 2.0;
+      static constexpr double MIN_THRESHOLD = 2.0;
+
+   private:
+      double m_Window = INITIAL_WINDOW;
+      double m_SlowStartThreshold = 64.0;
+   };
+}
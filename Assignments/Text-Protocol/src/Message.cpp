@@ -25,6 +25,7 @@ SOFTWARE.
 */
 
 #include "Message.h"
+#include <cstdio>
 
 template <typename Enum>
 constexpr auto toBytes( Enum e ) noexcept // https://stackoverflow.com/a/33083231/8480874
@@ -102,54 +103,82 @@ std::string TextProtocol::Message::ToByteStream() const
    std::string portBuffer( reinterpret_cast<const char*>( &port ), sizeof( port ) );
    portBuffer.insert( portBuffer.begin(), 2 - portBuffer.length(), '0' );
 
-   rawBuffer += seqBuffer + ipBuffer + portBuffer;
+   auto window = endianSwap( m_Window );
+   std::string windowBuffer( reinterpret_cast<const char*>( &window ), sizeof( window ) );
+
+   auto ack = endianSwap( m_AckNum );
+   std::string ackBuffer( reinterpret_cast<const char*>( &ack ), sizeof( ack ) );
+
+   auto sack = endianSwap( m_SackBits );
+   std::string sackBuffer( reinterpret_cast<const char*>( &sack ), sizeof( sack ) );
+
+   rawBuffer += seqBuffer + ipBuffer + portBuffer + windowBuffer + ackBuffer + sackBuffer;
 
    return rawBuffer + m_Payload;
 }
 
-TextProtocol::Message TextProtocol::Message::Parse( const std::string & rawBytes )
+TextProtocol::Message::Message( const MessageView& view ) :
+   m_PacketType( view.m_PacketType ), m_SeqNum( view.m_SeqNum ), m_DstIp( view.m_DstIp ), m_DstPort( view.m_DstPort ),
+   m_Window( view.m_Window ), m_AckNum( view.m_AckNum ), m_SackBits( view.m_SackBits ), m_Payload( view.m_Payload )
 {
-   // TO DO: throw parse error is length < 11
-   //unsigned short p1 = rawBytes[ 9 ] & 0x00ffu;
-   //unsigned short p2 = rawBytes[ 10 ] << 8u;
-
-   //auto port{ p1 | p2 };
+}
 
-   const uint32_t b0 = rawBytes[ 5 ] << 24u;
-   const uint32_t b1 = rawBytes[ 6 ] << 16u;
-   const uint32_t b2 = rawBytes[ 7 ] << 8u;
-   const uint32_t b3 = rawBytes[ 8 ];
+TextProtocol::MessageView TextProtocol::Message::AsView() const
+{
+   return { m_PacketType, m_SeqNum, m_DstIp, m_DstPort, m_Window, m_AckNum, m_SackBits, m_Payload };
+}
 
-   const uint32_t ipAddr{ b0 | b1 | b2 | b3 };
+TextProtocol::Message TextProtocol::Message::Parse( const std::string & rawBytes )
+{
+   return Message( View( rawBytes ) );
+}
 
-   Message obtained{ PacketType{ static_cast<unsigned char>( rawBytes[ 0 ] ) },
-           endianSwap( SequenceNumber{ static_cast<unsigned long>( rawBytes[ 1 ] << 24u | rawBytes[ 2 ] << 16u | rawBytes[ 3 ] << 8u | rawBytes[ 4 ] ) } ),
-           endianSwap( IpV4Address{ static_cast<unsigned long>( rawBytes[ 5 ] << 24u | rawBytes[ 6 ] << 16u | rawBytes[ 7 ] << 8u | rawBytes[ 8 ] ) } ),
-           PortNumber{ static_cast<unsigned short>( rawBytes[ 9 ] << 8u | ( rawBytes[ 10 ] & 0x00ff ) ) }
+TextProtocol::MessageView TextProtocol::Message::View( std::string_view rawBytes )
+{
+   if( rawBytes.length() < BASE_PACKET_SIZE )
+      throw ParseError( "datagram is shorter than the message header" );
+
+   // Bytes must be widened as unsigned otherwise anything above 0x7f gets sign extended over its neighbours
+   const auto byte = [ rawBytes ]( size_t index ) -> uint32_t { return static_cast<unsigned char>( rawBytes[ index ] ); };
+
+   return { PacketType{ static_cast<unsigned char>( rawBytes[ 0 ] ) },
+            endianSwap( SequenceNumber{ byte( 1 ) << 24u | byte( 2 ) << 16u | byte( 3 ) << 8u | byte( 4 ) } ),
+            endianSwap( IpV4Address{ byte( 5 ) << 24u | byte( 6 ) << 16u | byte( 7 ) << 8u | byte( 8 ) } ),
+            PortNumber{ static_cast<unsigned short>( byte( 9 ) << 8u | byte( 10 ) ) },
+            WindowSize{ static_cast<unsigned short>( byte( 11 ) << 8u | byte( 12 ) ) },
+            SequenceNumber{ byte( 13 ) << 24u | byte( 14 ) << 16u | byte( 15 ) << 8u | byte( 16 ) },
+            SackBitmap{ byte( 17 ) << 24u | byte( 18 ) << 16u | byte( 19 ) << 8u | byte( 20 ) },
+            rawBytes.substr( BASE_PACKET_SIZE )
    };
+}
 
-   obtained.m_Payload = rawBytes.substr( 11 );
-
-   return obtained;
+const char* TextProtocol::ToString( PacketType type )
+{
+   switch( type )
+   {
+   case TextProtocol::PacketType::DATA: return "DATA";
+   case TextProtocol::PacketType::FIN: return "FIN";
+   case TextProtocol::PacketType::RESUME: return "RESUME";
+   case TextProtocol::PacketType::ACK: return "ACK";
+   case TextProtocol::PacketType::NACK: return "NACK";
+   case TextProtocol::PacketType::SYN: return "SYN";
+   case TextProtocol::PacketType::SYN_ACK: return "SYN_ACK";
+   default: return "??";
+   }
 }
 
 std::ostream& TextProtocol::operator<<( std::ostream & os, const TextProtocol::Message & message )
+{
+   return os << message.AsView();
+}
+
+std::ostream& TextProtocol::operator<<( std::ostream & os, const TextProtocol::MessageView & message )
 {
    using std::operator<<; // Enable ADL
 
    operator<<( os, std::string{ "MSG: { " } );
 
-   os << [ type = message.m_PacketType ]()->std::string
-   {
-      switch( type )
-      {
-      case TextProtocol::PacketType::ACK: return "ACK";
-      case TextProtocol::PacketType::NACK: return "NACK";
-      case TextProtocol::PacketType::SYN: return "SYN";
-      case TextProtocol::PacketType::SYN_ACK: return "SYN_ACK";
-      default: return "??";
-      }
-   }( );
+   os << std::string{ ToString( message.m_PacketType ) };
 
    operator<<( os, " } Seq=" + std::to_string( toBytes( message.m_SeqNum ) ) + " @=" );
 
@@ -159,5 +188,14 @@ std::ostream& TextProtocol::operator<<( std::ostream & os, const TextProtocol::M
       << std::to_string( ( message.m_DstIp & 0xff000000 ) >> 24u ) << std::string{ ":" }
    << std::to_string( toBytes( message.m_DstPort ) );
 
+   operator<<( os, " Win=" + std::to_string( toBytes( message.m_Window ) ) + " Ack=" + std::to_string( toBytes( message.m_AckNum ) ) );
+
+   if( toBytes( message.m_SackBits ) != 0 )
+   {
+      char sack[ 16 ];
+      std::snprintf( sack, sizeof( sack ), "%08x", toBytes( message.m_SackBits ) );
+      operator<<( os, std::string( " Sack=" ) + sack );
+   }
+
    return os;
 }
@@ -26,7 +26,10 @@ SOFTWARE.
 
 #pragma once
 
+#include <cstdint>
+#include <stdexcept>
 #include <string>
+#include <string_view>
 
 // In little endian, a 32bit integer value of 1 is represented in hex as `0x01 0x00 0x00 0x00`
 constexpr auto TEST_BYTE = 1;
@@ -67,39 +70,75 @@ namespace TextProtocol
 
    enum class PacketType : unsigned char
    {
+      DATA = 0x02,
+      FIN = 0x04, // last DATA packet of a stream
+      RESUME = 0x05, // replaces the handshake, payload is a token from a previous SYN_ACK
       ACK = 0x06,
       NACK = 0x15,
       SYN = 0x16,
       SYN_ACK = SYN + ACK
    };
 
-   enum class SequenceNumber : unsigned long { MAX = 0xffffffffUL };
+   enum class SequenceNumber : uint32_t { MAX = 0xffffffffUL };
 
-   enum class IpV4Address : unsigned long { };
+   enum class IpV4Address : uint32_t { };
 
    enum class PortNumber : unsigned short { };
 
+   enum class WindowSize : unsigned short { }; // number of packets the sender of the message is willing to buffer
+
+   enum class SackBitmap : uint32_t { }; // bit N set when the packet at AckNum + 1 + N was received
+
+
+   // Non-owning view of a datagram, only valid for as long as the bytes it was parsed from
+   struct MessageView
+   {
+      PacketType m_PacketType;
+      SequenceNumber m_SeqNum;
+      IpV4Address m_DstIp;
+      PortNumber m_DstPort;
+      WindowSize m_Window;
+      SequenceNumber m_AckNum;
+      SackBitmap m_SackBits;
+      std::string_view m_Payload;
+   };
+
+   const char* ToString( PacketType type );
+
+   std::ostream& operator<<( std::ostream& os, const MessageView& message );
 
    class Message
    {
    public:
       Message( PacketType type, SequenceNumber id, IpV4Address dstIp, PortNumber port );
+      explicit Message( const MessageView& view );
 
       size_t Size() const;
       std::string ToByteStream() const;
+      MessageView AsView() const;
 
       friend std::ostream& operator<<(std::ostream& os, const Message& message );
 
       static Message Parse( const std::string& rawBytes );
+      static MessageView View( std::string_view rawBytes ); // does not copy the payload
+
+      using ParseError = std::runtime_error;
+
+      // The router only looks at the first fields, everything after is forwarded as is
+      static constexpr auto ROUTER_HEADER_SIZE = sizeof( PacketType ) + sizeof( SequenceNumber ) + sizeof( IpV4Address ) + sizeof( PortNumber );
+      static constexpr auto BASE_PACKET_SIZE = ROUTER_HEADER_SIZE + sizeof( WindowSize ) + sizeof( SequenceNumber ) + sizeof( SackBitmap );
+      static constexpr auto MAX_MESSAGE_SIZE = 1024;
+      static constexpr auto MAX_PAYLOAD_LENGTH = MAX_MESSAGE_SIZE - BASE_PACKET_SIZE;
 
-      static constexpr auto BASE_PACKET_SIZE = sizeof( PacketType ) + sizeof( SequenceNumber ) + sizeof( IpV4Address ) + sizeof( PortNumber );
-      static constexpr auto MAX_PAYLOAD_LENGTH = 1013;
-      static constexpr auto MAX_MESSAGE_SIZE = BASE_PACKET_SIZE + MAX_PAYLOAD_LENGTH;
+      static constexpr WindowSize DEFAULT_WINDOW{ 64 };
 
       PacketType m_PacketType;
       SequenceNumber m_SeqNum;
       IpV4Address m_DstIp;
       PortNumber m_DstPort;
-      std::string m_Payload = "Hello World!"; // max 1014 bytes
+      WindowSize m_Window = DEFAULT_WINDOW;
+      SequenceNumber m_AckNum{ 0 }; // cumulative, everything before was received
+      SackBitmap m_SackBits{ 0 };
+      std::string m_Payload = "Hello World!"; // max 1003 bytes
    };
 }
@@ -0,0 +1,96 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Chris McArthur, prince.chrismc(at)gmail(dot)com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include "Message.h"
+
+#ifdef _WIN32
+#include <winsock2.h>
+#else
+#include <netinet/in.h>
+#endif
+
+namespace TextProtocol
+{
+   // Preallocated storage for a single datagram, filled directly by the socket
+   struct PacketSlot
+   {
+      std::string_view Bytes() const { return { m_Buffer.data(), m_Length }; }
+      MessageView View() const { return Message::View( Bytes() ); }
+
+      std::array<char, Message::MAX_MESSAGE_SIZE> m_Buffer;
+      size_t m_Length = 0;
+      sockaddr_in m_From{}; // who sent it, replies go straight back without asking the socket
+
+   };
+
+   //
+   // Lock-free single producer, single consumer ring of packet slots. The receive thread claims a slot, fills it
+   // and publishes it; the protocol thread peeks at it in place and releases it once done. Slots are recycled
+   // forever so nothing is allocated after construction.
+   //
+   template <size_t Capacity = 64>
+   class PacketRing
+   {
+      static_assert( Capacity > 1 && ( Capacity & ( Capacity - 1 ) ) == 0, "capacity must be a power of two" );
+
+   public:
+      // Producer side
+      PacketSlot* Claim() noexcept
+      {
+         const auto head = m_Head.load( std::memory_order_relaxed );
+         if( head - m_Tail.load( std::memory_order_acquire ) == Capacity ) return nullptr; // full
+
+         return &m_Slots[ head & MASK ];
+      }
+
+      void Publish() noexcept { m_Head.store( m_Head.load( std::memory_order_relaxed ) + 1, std::memory_order_release ); }
+
+      // Consumer side
+      const PacketSlot* Peek() const noexcept
+      {
+         const auto tail = m_Tail.load( std::memory_order_relaxed );
+         if( tail == m_Head.load( std::memory_order_acquire ) ) return nullptr; // empty
+
+         return &m_Slots[ tail & MASK ];
+      }
+
+      void Release() noexcept { m_Tail.store( m_Tail.load( std::memory_order_relaxed ) + 1, std::memory_order_release ); }
+
+      bool IsEmpty() const noexcept { return m_Tail.load( std::memory_order_acquire ) == m_Head.load( std::memory_order_acquire ); }
+
+   private:
+      static constexpr size_t MASK = Capacity - 1;
+
+      // Each index lives on its own cache line so the two threads don't fight over it
+      alignas( 64 ) std::atomic<size_t> m_Head{ 0 }; // written by producer
+      alignas( 64 ) std::atomic<size_t> m_Tail{ 0 }; // written by consumer
+      std::array<PacketSlot, Capacity> m_Slots;
+   };
+}
@@ -0,0 +1,120 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Chris McArthur, prince.chrismc(at)gmail(dot)com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "ResumptionTokens.h"
+#include <random>
+
+static uint64_t rotl( uint64_t x, int b ) { return ( x << b ) | ( x >> ( 64 - b ) ); }
+
+static void sipRound( uint64_t& v0, uint64_t& v1, uint64_t& v2, uint64_t& v3 )
+{
+   v0 += v1; v1 = rotl( v1, 13 ); v1 ^= v0; v0 = rotl( v0, 32 );
+   v2 += v3; v3 = rotl( v3, 16 ); v3 ^= v2;
+   v0 += v3; v3 = rotl( v3, 21 ); v3 ^= v0;
+   v2 += v1; v1 = rotl( v1, 17 ); v1 ^= v2; v2 = rotl( v2, 32 );
+}
+
+// SipHash-2-4 over whole 64bit words, the input is always two words so no tail handling is needed
+static uint64_t sipHash( const std::array<uint64_t, 2>& key, const std::array<uint64_t, 2>& words )
+{
+   uint64_t v0 = 0x736f6d6570736575ULL ^ key[ 0 ];
+   uint64_t v1 = 0x646f72616e646f6dULL ^ key[ 1 ];
+   uint64_t v2 = 0x6c7967656e657261ULL ^ key[ 0 ];
+   uint64_t v3 = 0x7465646279746573ULL ^ key[ 1 ];
+
+   for( const uint64_t m : words )
+   {
+      v3 ^= m;
+      sipRound( v0, v1, v2, v3 );
+      sipRound( v0, v1, v2, v3 );
+      v0 ^= m;
+   }
+
+   const uint64_t last = static_cast<uint64_t>( words.size() * sizeof( uint64_t ) ) << 56;
+   v3 ^= last;
+   sipRound( v0, v1, v2, v3 );
+   sipRound( v0, v1, v2, v3 );
+   v0 ^= last;
+
+   v2 ^= 0xff;
+   for( int i = 0; i < 4; ++i ) sipRound( v0, v1, v2, v3 );
+
+   return v0 ^ v1 ^ v2 ^ v3;
+}
+
+static void writeWord( std::string& out, uint64_t word )
+{
+   for( int shift = 56; shift >= 0; shift -= 8 )
+      out.push_back( static_cast<char>( ( word >> shift ) & 0xff ) );
+}
+
+static uint64_t readWord( std::string_view in )
+{
+   uint64_t word = 0;
+   for( size_t i = 0; i < sizeof( uint64_t ); ++i )
+      word = ( word << 8 ) | static_cast<unsigned char>( in[ i ] );
+
+   return word;
+}
+
+static uint64_t toSeconds( TextProtocol::ResumptionTokens::TimePoint time )
+{
+   return static_cast<uint64_t>( std::chrono::duration_cast<std::chrono::seconds>( time.time_since_epoch() ).count() );
+}
+
+TextProtocol::ResumptionTokens::ResumptionTokens()
+{
+   std::random_device entropy;
+   for( auto& word : m_Key )
+      word = static_cast<uint64_t>( entropy() ) << 32 | entropy();
+}
+
+std::string TextProtocol::ResumptionTokens::Issue( IpV4Address client, TimePoint now ) const
+{
+   const uint64_t expiry = toSeconds( now + LIFETIME );
+
+   std::string token;
+   token.reserve( TOKEN_SIZE );
+   writeWord( token, expiry );
+   writeWord( token, sign( client, expiry ) );
+
+   return token;
+}
+
+bool TextProtocol::ResumptionTokens::Validate( std::string_view token, IpV4Address client, TimePoint now ) const
+{
+   if( token.size() != TOKEN_SIZE ) return false;
+
+   const uint64_t expiry = readWord( token );
+   if( expiry < toSeconds( now ) ) return false;
+
+   return readWord( token.substr( sizeof( uint64_t ) ) ) == sign( client, expiry );
+}
+
+uint64_t TextProtocol::ResumptionTokens::sign( IpV4Address client, uint64_t expiry ) const
+{
+   return sipHash( m_Key, { static_cast<uint64_t>( client ), expiry } );
+}
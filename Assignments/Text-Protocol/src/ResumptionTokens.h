@@ -0,0 +1,64 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Chris McArthur, prince.chrismc(at)gmail(dot)com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#pragma once
+
+#include "Message.h"
+#include <array>
+#include <chrono>
+#include <string>
+#include <string_view>
+
+namespace TextProtocol
+{
+   //
+   // Tokens handed out in the SYN_ACK so a returning client can skip the handshake. A token is the expiry time followed
+   // by a SipHash-2-4 of the client address and that expiry, keyed with a secret only the server knows. Nothing is stored
+   // per client, a restart simply invalidates every token and clients fall back to the handshake.
+   //
+   // Nothing stops a token and the request behind it from being replayed while the token lasts either. Rather than
+   // remember every token seen, the server only answers a GET or a HEAD without a handshake, which change nothing when
+   // answered twice. Any other request that follows a RESUME is refused and the client shakes hands for it.
+   //
+   class ResumptionTokens
+   {
+   public:
+      using TimePoint = std::chrono::system_clock::time_point;
+
+      ResumptionTokens(); // random key
+
+      std::string Issue( IpV4Address client, TimePoint now = std::chrono::system_clock::now() ) const;
+      bool Validate( std::string_view token, IpV4Address client, TimePoint now = std::chrono::system_clock::now() ) const;
+
+      static constexpr auto LIFETIME = std::chrono::hours( 1 );
+      static constexpr size_t TOKEN_SIZE = sizeof( uint64_t ) * 2;
+
+   private:
+      std::array<uint64_t, 2> m_Key;
+
+      uint64_t sign( IpV4Address client, uint64_t expiry ) const;
+   };
+}
@@ -46,6 +46,21 @@ bool TextProtocol::Socket::Send( CSimpleSocket& socket, const Message& toSend )
    return ( static_cast<size_t>( bytesSent ) == toSend.Size() );
 }
 
+// The socket's own Send and Receive share its peer address and counters, these go to the descriptor so a sending
+// thread and a receiving one never touch the same state
+bool TextProtocol::Socket::Send( CSimpleSocket& socket, const Message& toSend, const sockaddr_in& to )
+{
+   const std::string msgPayload = toSend.ToByteStream();
+
+   if( msgPayload.length() < Message::BASE_PACKET_SIZE )
+      throw std::logic_error( "no point in sending an incomplete message" );
+
+   const auto bytesSent = ::sendto( socket.GetSocketDescriptor(), msgPayload.data(), static_cast<int>( msgPayload.length() ), 0,
+                                    reinterpret_cast<const sockaddr*>( &to ), sizeof( to ) );
+
+   return ( bytesSent >= 0 && static_cast<size_t>( bytesSent ) == toSend.Size() );
+}
+
 std::optional<TextProtocol::Message> TextProtocol::Socket::Receive( CSimpleSocket& socket )
 {
    auto bytesObtained = -1;
@@ -54,9 +69,27 @@ std::optional<TextProtocol::Message> TextProtocol::Socket::Receive( CSimpleSocke
       //std::cout << "Socket::Receive >> " << bytesObtained << " from "
       //   << socket.GetClientAddr() << ":" << socket.GetClientPort() << std::endl;
 
-      return Message::Parse( socket.GetData() );
+      try
+      {
+         return Message::Parse( socket.GetData() );
+      }
+      catch( const Message::ParseError& )
+      {
+         return{}; // runt datagram, nothing to recover
+      }
    }
 
    //std::cout << "Socket::Receive >> " << socket.DescribeError() << std::endl;
    return{};
 }
+
+bool TextProtocol::Socket::Receive( CSimpleSocket& socket, PacketSlot& slot )
+{
+   socklen_t fromLength = sizeof( slot.m_From );
+   const auto bytesObtained = ::recvfrom( socket.GetSocketDescriptor(), slot.m_Buffer.data(), static_cast<int>( slot.m_Buffer.size() ), 0,
+                                          reinterpret_cast<sockaddr*>( &slot.m_From ), &fromLength );
+
+   // Anything shorter than the header can not be parsed
+   slot.m_Length = ( bytesObtained > 0 ) ? static_cast<size_t>( bytesObtained ) : 0;
+   return slot.m_Length >= Message::BASE_PACKET_SIZE;
+}
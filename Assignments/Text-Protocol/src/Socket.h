@@ -28,11 +28,14 @@ SOFTWARE.
 
 #include <optional>
 #include "Message.h"
+#include "PacketRing.h"
 #include "SimpleSocket.h"
 
 namespace TextProtocol::Socket
 {
    // Common
    bool Send( CSimpleSocket& socket, const Message& toSend );
+   bool Send( CSimpleSocket& socket, const Message& toSend, const sockaddr_in& to ); // safe beside a thread receiving on it
    std::optional<Message> Receive( CSimpleSocket& socket );
+   bool Receive( CSimpleSocket& socket, PacketSlot& slot ); // fills the slot in place, no copies
 }
@@ -0,0 +1,290 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Chris McArthur, prince.chrismc(at)gmail(dot)com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "Transport.h"
+#include <algorithm>
+
+using namespace std::chrono_literals;
+
+static constexpr auto seqValue( TextProtocol::SequenceNumber seq ) { return static_cast<uint32_t>( seq ); }
+
+static constexpr auto operator+( TextProtocol::SequenceNumber seq, size_t offset )
+{
+   return TextProtocol::SequenceNumber{ static_cast<uint32_t>( seqValue( seq ) + offset ) };
+}
+
+// Signed distance so sequence numbers can wrap around
+static constexpr auto operator-( TextProtocol::SequenceNumber lhs, TextProtocol::SequenceNumber rhs )
+{
+   return static_cast<int32_t>( seqValue( lhs ) - seqValue( rhs ) );
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+//
+// Sender
+//
+//---------------------------------------------------------------------------------------------------------------------
+TextProtocol::Sender::Sender( SequenceNumber first, IpV4Address dstIp, PortNumber dstPort, std::string data, WindowSize peerWindow,
+                              Receiver* piggyback ) :
+   m_First( first ), m_DstIp( dstIp ), m_DstPort( dstPort ), m_Data( std::move( data ) ), m_Piggyback( piggyback ),
+   m_Segments( std::max<size_t>( 1, ( m_Data.length() + Message::MAX_PAYLOAD_LENGTH - 1 ) / Message::MAX_PAYLOAD_LENGTH ) ),
+   m_PeerWindow( static_cast<size_t>( peerWindow ) )
+{
+}
+
+void TextProtocol::Sender::Poll( Clock::time_point now, const Transmit& transmit )
+{
+   if( IsComplete() || m_bFailed ) return;
+
+   auto& oldest = m_Segments[ m_Base ];
+   if( oldest.m_Transmissions > 0 && now - oldest.m_SentAt >= m_Rtt.Rto() )
+   {
+      m_Congestion.OnTimeout();
+      m_Rtt.Backoff();
+      oldest.m_Lost = true;
+      m_RecoveryPoint = m_Next;
+   }
+
+   // Holes first, they are holding up the receiver
+   for( size_t index = m_Base; index < m_Next; index++ )
+   {
+      auto& segment = m_Segments[ index ];
+      if( !segment.m_Lost ) continue;
+
+      if( segment.m_Transmissions >= MAX_TRANSMISSIONS )
+      {
+         m_bFailed = true;
+         return;
+      }
+
+      if( !send( index, now, transmit ) ) return;
+      segment.m_Lost = false;
+   }
+
+   while( m_Next < m_Segments.size() && m_InFlight < window() )
+   {
+      if( !send( m_Next, now, transmit ) ) break;
+
+      ++m_Next;
+      ++m_InFlight;
+   }
+}
+
+void TextProtocol::Sender::OnAck( const MessageView& ack, Clock::time_point now )
+{
+   m_PeerWindow = static_cast<size_t>( ack.m_Window );
+
+   const auto cumulative = ack.m_AckNum - m_First;
+   if( cumulative < 0 || static_cast<size_t>( cumulative ) > m_Next ) return; // acknowledges something else entirely
+
+   const auto previousBase = m_Base;
+   Clock::time_point newestSample{};
+   bool bNewlyAcked = false;
+
+   for( size_t index = m_Base; index < static_cast<size_t>( cumulative ); index++ )
+      bNewlyAcked |= acknowledge( index, now, newestSample );
+
+   size_t highestSacked = 0;
+   const auto bitmap = static_cast<uint32_t>( ack.m_SackBits );
+   for( size_t bit = 0; bit < 32; bit++ )
+   {
+      const auto index = static_cast<size_t>( cumulative ) + 1 + bit;
+      if( index >= m_Next ) break;
+
+      if( bitmap & ( 1u << bit ) )
+      {
+         bNewlyAcked |= acknowledge( index, now, newestSample );
+         highestSacked = index;
+      }
+   }
+
+   if( newestSample != Clock::time_point{} )
+      m_Rtt.Sample( std::chrono::duration_cast<RttEstimator::Duration>( now - newestSample ) );
+
+   while( m_Base < m_Segments.size() && m_Segments[ m_Base ].m_Acked ) ++m_Base;
+
+   if( m_Base != previousBase )
+   {
+      m_DuplicateAcks = 0;
+      return;
+   }
+
+   // The receiver is still stuck on the same packet but others keep making it across
+   if( bNewlyAcked && ++m_DuplicateAcks >= FAST_RETRANSMIT_THRESHOLD && m_Base >= m_RecoveryPoint )
+   {
+      m_Congestion.OnFastRetransmit();
+      m_RecoveryPoint = m_Next;
+
+      // Everything below the highest selectively acknowledged packet that is still missing was lost
+      for( size_t index = m_Base; index < highestSacked; index++ )
+         m_Segments[ index ].m_Lost = !m_Segments[ index ].m_Acked;
+   }
+}
+
+TextProtocol::Clock::time_point TextProtocol::Sender::NextTimeout() const
+{
+   if( IsComplete() || m_Segments[ m_Base ].m_Transmissions == 0 ) return Clock::now() + m_Rtt.Rto();
+
+   return m_Segments[ m_Base ].m_SentAt + m_Rtt.Rto();
+}
+
+TextProtocol::SequenceNumber TextProtocol::Sender::End() const
+{
+   return m_First + m_Segments.size();
+}
+
+bool TextProtocol::Sender::send( size_t index, Clock::time_point now, const Transmit& transmit )
+{
+   const bool bIsLast = ( index + 1 == m_Segments.size() );
+   Message segment( bIsLast ? PacketType::FIN : PacketType::DATA, m_First + index, m_DstIp, m_DstPort );
+   segment.m_Payload = m_Data.substr( index * Message::MAX_PAYLOAD_LENGTH, Message::MAX_PAYLOAD_LENGTH );
+
+   if( m_Piggyback != nullptr ) m_Piggyback->Stamp( segment );
+
+   if( !transmit( segment ) ) return false;
+
+   m_Segments[ index ].m_SentAt = now;
+   m_Segments[ index ].m_Transmissions += 1;
+   return true;
+}
+
+bool TextProtocol::Sender::acknowledge( size_t index, Clock::time_point now, Clock::time_point& newestSample )
+{
+   auto& segment = m_Segments[ index ];
+   if( segment.m_Acked ) return false;
+
+   segment.m_Acked = true;
+   segment.m_Lost = false;
+   --m_InFlight;
+
+   m_Congestion.OnAck();
+
+   // Karn's algorithm, a retransmitted packet can't tell which copy is being acknowledged
+   if( segment.m_Transmissions == 1 && segment.m_SentAt > newestSample && segment.m_SentAt <= now )
+      newestSample = segment.m_SentAt;
+
+   return true;
+}
+
+size_t TextProtocol::Sender::window() const
+{
+   // Never let a zero window stall the transfer, one packet acts as a probe
+   return std::max<size_t>( 1, std::min( m_Congestion.Size(), m_PeerWindow ) );
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+//
+// Receiver
+//
+//---------------------------------------------------------------------------------------------------------------------
+TextProtocol::Receiver::Receiver( SequenceNumber first, IpV4Address peerIp, PortNumber peerPort, WindowSize window ) :
+   m_Expected( first ), m_PeerIp( peerIp ), m_PeerPort( peerPort ),
+   m_Pending( static_cast<size_t>( window ) ), m_PendingType( static_cast<size_t>( window ) ), m_Present( static_cast<size_t>( window ) )
+{
+}
+
+std::optional<TextProtocol::Message> TextProtocol::Receiver::OnData( const MessageView& data, Clock::time_point now )
+{
+   if( data.m_PacketType != PacketType::DATA && data.m_PacketType != PacketType::FIN ) return{};
+
+   const auto offset = data.m_SeqNum - m_Expected;
+   if( offset >= static_cast<int32_t>( m_Pending.size() ) ) return{}; // no room, sender will retry
+
+   if( offset < 0 || m_bComplete || isPresent( data.m_SeqNum ) )
+      return acknowledgement(); // duplicate, the previous acknowledgement must have been lost
+
+   const auto slot = slotOf( offset );
+   m_Pending[ slot ].assign( data.m_Payload );
+   m_PendingType[ slot ] = data.m_PacketType;
+   m_Present[ slot ] = true;
+   ++m_Buffered;
+
+   if( offset > 0 )
+      return acknowledgement(); // gap, let the sender know right away
+
+   // Deliver everything that is now contiguous
+   const bool bFilledGap = m_Buffered > 1;
+   for( auto next = slot; m_Present[ next ] && !m_bComplete; next = m_Base )
+   {
+      m_Data.append( m_Pending[ next ] );
+      m_bComplete = ( m_PendingType[ next ] == PacketType::FIN );
+      m_Present[ next ] = false;
+      --m_Buffered;
+      m_Expected = m_Expected + 1;
+      m_Base = ( m_Base + 1 ) % m_Pending.size();
+   }
+
+   if( m_bComplete || bFilledGap || ++m_Unacknowledged >= ACK_EVERY )
+      return acknowledgement();
+
+   if( !m_AckDeadline.has_value() )
+      m_AckDeadline = now + ACK_DELAY;
+
+   return{};
+}
+
+std::optional<TextProtocol::Message> TextProtocol::Receiver::Poll( Clock::time_point now )
+{
+   if( m_AckDeadline.has_value() && now >= *m_AckDeadline )
+      return acknowledgement();
+
+   return{};
+}
+
+void TextProtocol::Receiver::Stamp( Message& outgoing )
+{
+   outgoing.m_Window = available();
+   outgoing.m_AckNum = m_Expected;
+
+   uint32_t bitmap = 0;
+   for( uint32_t bit = 0; bit < 32 && bit + 1 < m_Pending.size(); bit++ )
+   {
+      if( isPresent( m_Expected + ( bit + 1 ) ) ) bitmap |= ( 1u << bit );
+   }
+   outgoing.m_SackBits = SackBitmap{ bitmap };
+
+   m_Unacknowledged = 0;
+   m_AckDeadline.reset();
+}
+
+TextProtocol::Message TextProtocol::Receiver::acknowledgement()
+{
+   Message ack( PacketType::ACK, m_Expected, m_PeerIp, m_PeerPort );
+   ack.m_Payload.clear();
+   Stamp( ack );
+   return ack;
+}
+
+TextProtocol::WindowSize TextProtocol::Receiver::available() const
+{
+   return WindowSize{ static_cast<unsigned short>( m_Pending.size() - m_Buffered ) };
+}
+
+bool TextProtocol::Receiver::isPresent( SequenceNumber seq ) const
+{
+   const auto offset = seq - m_Expected;
+   return offset >= 0 && offset < static_cast<int32_t>( m_Pending.size() ) && m_Present[ slotOf( offset ) ];
+}
@@ -0,0 +1,151 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Chris McArthur, prince.chrismc(at)gmail(dot)com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#pragma once
+
+#include <functional>
+#include <optional>
+#include <vector>
+#include "Congestion.h"
+#include "Message.h"
+
+namespace TextProtocol
+{
+   using Clock = std::chrono::steady_clock;
+
+   class Receiver;
+
+   //
+   // Reliably delivers a stream to a peer, keeping as many packets in flight as both the congestion window and the
+   // peer's advertised receive window allow. Driven by the caller: feed it every packet from the peer and poll it
+   // regularly, it only ever transmits through the callback it is handed.
+   //
+   // Acknowledgements are cumulative with a selective bitmap, so after a burst of losses exactly the missing
+   // packets are retransmitted. When the peer is also sending to us, our own acknowledgements ride along on the
+   // segments instead of going out on their own.
+   //
+   class Sender
+   {
+   public:
+      using Transmit = std::function<bool( const Message& )>;
+
+      Sender( SequenceNumber first, IpV4Address dstIp, PortNumber dstPort, std::string data,
+              WindowSize peerWindow = Message::DEFAULT_WINDOW, Receiver* piggyback = nullptr );
+
+      void Poll( Clock::time_point now, const Transmit& transmit );
+      void OnAck( const MessageView& ack, Clock::time_point now ); // any packet type, only the ACK fields are used
+
+      bool IsComplete() const { return m_Base == m_Segments.size(); }
+      bool HasFailed() const { return m_bFailed; }
+
+      Clock::time_point NextTimeout() const;
+      SequenceNumber End() const; // first sequence number after the stream
+
+      const RttEstimator& GetRttEstimator() const { return m_Rtt; }
+
+      static constexpr auto MAX_TRANSMISSIONS = 8;
+      static constexpr auto FAST_RETRANSMIT_THRESHOLD = 3;
+
+   private:
+      struct Segment
+      {
+         Clock::time_point m_SentAt{};
+         unsigned m_Transmissions = 0;
+         bool m_Acked = false;
+         bool m_Lost = false; // reported missing by the SACK bitmap, waiting to be retransmitted
+      };
+
+      bool send( size_t index, Clock::time_point now, const Transmit& transmit );
+      bool acknowledge( size_t index, Clock::time_point now, Clock::time_point& newestSample );
+      size_t window() const;
+
+      const SequenceNumber m_First;
+      const IpV4Address m_DstIp;
+      const PortNumber m_DstPort;
+      const std::string m_Data;
+      Receiver* m_Piggyback;
+
+      std::vector<Segment> m_Segments;
+      size_t m_Base = 0;     // oldest unacknowledged segment
+      size_t m_Next = 0;     // next segment never sent
+      size_t m_InFlight = 0;
+      size_t m_RecoveryPoint = 0; // no new loss reaction until everything sent before the last one is acknowledged
+      unsigned m_DuplicateAcks = 0;
+      bool m_bFailed = false;
+
+      size_t m_PeerWindow;
+      RttEstimator m_Rtt;
+      CongestionWindow m_Congestion;
+   };
+
+   //
+   // Reassembles a stream sent by a peer's Sender. Packets that arrive ahead of a gap are buffered as long as they
+   // fit in the advertised window. In order packets are acknowledged every other packet or after a short delay,
+   // anything unusual ( gaps, duplicates, the end of the stream ) is acknowledged straight away.
+   //
+   class Receiver
+   {
+   public:
+      Receiver( SequenceNumber first, IpV4Address peerIp, PortNumber peerPort, WindowSize window = Message::DEFAULT_WINDOW );
+
+      std::optional<Message> OnData( const MessageView& data, Clock::time_point now ); // acknowledgement to send, if it's due
+      std::optional<Message> Poll( Clock::time_point now );                            // delayed acknowledgement, if it's due
+
+      bool IsComplete() const { return m_bComplete; }
+      const std::string& GetData() const { return m_Data; }
+      SequenceNumber End() const { return m_Expected; }
+
+      void Stamp( Message& outgoing ); // fills in the ACK fields, which satisfies any pending acknowledgement
+      std::optional<Clock::time_point> NextAckDeadline() const { return m_AckDeadline; }
+
+      static constexpr auto ACK_DELAY = std::chrono::milliseconds( 10 ); // well under RttEstimator::MIN_RTO
+      static constexpr auto ACK_EVERY = 2;
+
+   private:
+      Message acknowledgement();
+      WindowSize available() const;
+      bool isPresent( SequenceNumber seq ) const;
+      size_t slotOf( int32_t offset ) const { return ( m_Base + static_cast<size_t>( offset ) ) % m_Pending.size(); }
+
+      SequenceNumber m_Expected;
+      const IpV4Address m_PeerIp;
+      const PortNumber m_PeerPort;
+
+      // A ring indexed by the distance from m_Expected, whose slot is m_Base. The sequence number itself would not do,
+      // it wraps at 2^32 which only lines up with the ring for a window that is a power of two.
+      std::vector<std::string> m_Pending;
+      size_t m_Base = 0;
+      std::vector<PacketType> m_PendingType;
+      std::vector<bool> m_Present;
+      size_t m_Buffered = 0;
+
+      unsigned m_Unacknowledged = 0;
+      std::optional<Clock::time_point> m_AckDeadline;
+
+      std::string m_Data;
+      bool m_bComplete = false;
+   };
+}
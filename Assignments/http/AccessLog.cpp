@@ -0,0 +1,269 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Chris McArthur, prince.chrismc(at)gmail(dot)com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "AccessLog.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdio>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace
+{
+   struct Record
+   {
+      std::chrono::system_clock::time_point m_tWhen;
+      const char* m_pEvent;
+      size_t m_ulLength;
+      char m_Text[ Http::AccessLog::RECORD_SIZE ];
+   };
+
+   // Written by its thread alone and read by the writer alone, the two only share the head and tail
+   struct ThreadBuffer
+   {
+      std::array<Record, Http::AccessLog::RECORDS_PER_THREAD> m_Records;
+      std::atomic<size_t> m_ulHead{ 0 }; // next record for the writer
+      std::atomic<size_t> m_ulTail{ 0 }; // next record for the thread
+      std::atomic<size_t> m_nDropped{ 0 };
+      std::atomic<bool> m_bAbandoned{ false }; // its thread is gone, removed once empty
+      size_t m_nSeen = 0; // for sampling, starts at the thread index so short lived threads take turns
+      unsigned m_uThread = 0;
+   };
+
+   struct Registration
+   {
+      std::shared_ptr<ThreadBuffer> m_pBuffer;
+
+      ~Registration()
+      {
+         if( m_pBuffer ) m_pBuffer->m_bAbandoned = true;
+      }
+   };
+}
+
+static std::atomic<bool> s_bOpen( false );
+static std::atomic<unsigned> s_uSampleEvery( 1 );
+
+static std::mutex s_muBuffers; // only taken when a thread logs for the first time and by the writer
+static std::vector<std::shared_ptr<ThreadBuffer>> s_vecBuffers;
+static unsigned s_uNextThread = 0;
+
+static std::mutex s_muWriter;
+static std::condition_variable s_cvWriter;
+static bool s_bStopWriter = false;
+static std::thread s_oWriter;
+static FILE* s_pFile = nullptr;
+
+static ThreadBuffer& threadBuffer()
+{
+   thread_local Registration s_oRegistration;
+   if( !s_oRegistration.m_pBuffer )
+   {
+      s_oRegistration.m_pBuffer = std::make_shared<ThreadBuffer>();
+
+      std::lock_guard<std::mutex> oLock( s_muBuffers );
+      s_oRegistration.m_pBuffer->m_uThread = s_uNextThread++;
+      s_oRegistration.m_pBuffer->m_nSeen = s_oRegistration.m_pBuffer->m_uThread;
+      s_vecBuffers.push_back( s_oRegistration.m_pBuffer );
+   }
+
+   return *s_oRegistration.m_pBuffer;
+}
+
+static void appendTimestamp( std::string& batch, std::chrono::system_clock::time_point when )
+{
+   const std::time_t tSeconds = std::chrono::system_clock::to_time_t( when );
+   const auto ulMicros = std::chrono::duration_cast<std::chrono::microseconds>( when.time_since_epoch() ).count() % 1000000;
+
+   char buffer[ 32 ];
+   const size_t ulLength = std::strftime( buffer, sizeof( buffer ), "%Y-%m-%dT%H:%M:%S", std::gmtime( &tSeconds ) ); // only the writer calls this
+   batch.append( buffer, ulLength );
+
+   std::snprintf( buffer, sizeof( buffer ), ".%06dZ", static_cast<int>( ulMicros ) );
+   batch.append( buffer );
+}
+
+// Moves everything logged so far into the file with a single write
+static void drainBuffers( std::string& batch )
+{
+   std::vector<std::shared_ptr<ThreadBuffer>> vecBuffers;
+   {
+      std::lock_guard<std::mutex> oLock( s_muBuffers );
+      vecBuffers = s_vecBuffers;
+   }
+
+   batch.clear();
+   for( const auto& pBuffer : vecBuffers )
+   {
+      const size_t ulTail = pBuffer->m_ulTail.load( std::memory_order_acquire );
+      size_t ulHead = pBuffer->m_ulHead.load( std::memory_order_relaxed );
+
+      for( ; ulHead != ulTail; ulHead += 1 )
+      {
+         const Record& oRecord = pBuffer->m_Records[ ulHead % Http::AccessLog::RECORDS_PER_THREAD ];
+
+         batch.append( "ts=" );
+         appendTimestamp( batch, oRecord.m_tWhen );
+         batch.append( " thread=" ).append( std::to_string( pBuffer->m_uThread ) );
+         batch.append( " event=" ).append( oRecord.m_pEvent );
+         if( oRecord.m_ulLength > 0 ) batch.append( " " ).append( oRecord.m_Text, oRecord.m_ulLength );
+         batch.append( "\n" );
+      }
+
+      pBuffer->m_ulHead.store( ulHead, std::memory_order_release );
+
+      if( const size_t nDropped = pBuffer->m_nDropped.exchange( 0, std::memory_order_relaxed ); nDropped > 0 )
+      {
+         batch.append( "ts=" );
+         appendTimestamp( batch, std::chrono::system_clock::now() );
+         batch.append( " thread=" ).append( std::to_string( pBuffer->m_uThread ) );
+         batch.append( " event=dropped count=" ).append( std::to_string( nDropped ) ).append( "\n" );
+      }
+   }
+
+   if( !batch.empty() )
+   {
+      std::fwrite( batch.data(), 1, batch.size(), s_pFile );
+      std::fflush( s_pFile );
+   }
+
+   // Threads that are gone have nothing more to say once their last records are out
+   std::lock_guard<std::mutex> oLock( s_muBuffers );
+   for( auto itor = s_vecBuffers.begin(); itor != s_vecBuffers.end(); /* no itor */ )
+   {
+      const ThreadBuffer& oBuffer = **itor;
+      const bool bFinished = oBuffer.m_bAbandoned && oBuffer.m_ulHead == oBuffer.m_ulTail && oBuffer.m_nDropped == 0;
+      itor = bFinished ? s_vecBuffers.erase( itor ) : itor + 1;
+   }
+}
+
+void Http::AccessLog::Open( const Options& options )
+{
+   Close();
+
+   s_pFile = ( options.m_sPath == "-" ) ? stdout : std::fopen( options.m_sPath.c_str(), "a" );
+   if( s_pFile == nullptr ) throw std::runtime_error( "Unable to open the access log " + options.m_sPath );
+
+   s_uSampleEvery = options.m_uSampleEvery > 0 ? options.m_uSampleEvery : 1;
+   s_bStopWriter = false;
+
+   s_oWriter = std::thread( [ interval = options.m_FlushInterval ]
+                            {
+                               std::string batch;
+                               std::unique_lock<std::mutex> oLock( s_muWriter );
+                               while( !s_cvWriter.wait_for( oLock, interval, [] { return s_bStopWriter; } ) )
+                                  drainBuffers( batch );
+
+                               drainBuffers( batch );
+                            } );
+
+   s_bOpen.store( true, std::memory_order_release );
+}
+
+void Http::AccessLog::Close()
+{
+   if( !s_oWriter.joinable() ) return;
+
+   s_bOpen.store( false, std::memory_order_release );
+   {
+      std::lock_guard<std::mutex> oLock( s_muWriter );
+      s_bStopWriter = true;
+   }
+   s_cvWriter.notify_all();
+   s_oWriter.join();
+
+   if( s_pFile != stdout ) std::fclose( s_pFile );
+   s_pFile = nullptr;
+}
+
+bool Http::AccessLog::IsOpen()
+{
+   return s_bOpen.load( std::memory_order_relaxed );
+}
+
+void Http::AccessLog::Write( const char* event, const char* format, ... )
+{
+   if( !s_bOpen.load( std::memory_order_acquire ) ) return;
+
+   ThreadBuffer& oBuffer = threadBuffer();
+   if( oBuffer.m_nSeen++ % s_uSampleEvery.load( std::memory_order_relaxed ) != 0 ) return;
+
+   const size_t ulTail = oBuffer.m_ulTail.load( std::memory_order_relaxed );
+   if( ulTail - oBuffer.m_ulHead.load( std::memory_order_acquire ) == RECORDS_PER_THREAD )
+   {
+      oBuffer.m_nDropped.fetch_add( 1, std::memory_order_relaxed );
+      return;
+   }
+
+   Record& oRecord = oBuffer.m_Records[ ulTail % RECORDS_PER_THREAD ];
+   oRecord.m_tWhen = std::chrono::system_clock::now();
+   oRecord.m_pEvent = event;
+
+   va_list args;
+   va_start( args, format );
+   const int nLength = std::vsnprintf( oRecord.m_Text, sizeof( oRecord.m_Text ), format, args );
+   va_end( args );
+
+   oRecord.m_ulLength = nLength < 0 ? 0 : std::min( static_cast<size_t>( nLength ), sizeof( oRecord.m_Text ) - 1 );
+
+   oBuffer.m_ulTail.store( ulTail + 1, std::memory_order_release );
+}
+
+const char* Http::AccessLog::Escape( std::string_view value, char* buffer, size_t size )
+{
+   static constexpr char HEX_DIGITS[] = "0123456789abcdef";
+
+   size_t ulUsed = 0;
+   for( const char c : value )
+   {
+      const auto uChar = static_cast<unsigned char>( c );
+      const bool bControl = uChar < 0x20 || uChar == 0x7f;
+      const size_t ulNeeded = bControl ? 4 : ( c == '"' || c == '\\' ) ? 2 : 1;
+      if( ulUsed + ulNeeded >= size ) break; // never half an escape, and room for the terminator
+
+      if( bControl )
+      {
+         buffer[ ulUsed++ ] = '\\';
+         buffer[ ulUsed++ ] = 'x';
+         buffer[ ulUsed++ ] = HEX_DIGITS[ uChar >> 4 ];
+         buffer[ ulUsed++ ] = HEX_DIGITS[ uChar & 0xf ];
+         continue;
+      }
+
+      if( ulNeeded == 2 ) buffer[ ulUsed++ ] = '\\';
+      buffer[ ulUsed++ ] = c;
+   }
+
+   if( size > 0 ) buffer[ ulUsed ] = '\0';
+   return buffer;
+}
@@ -0,0 +1,70 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Chris McArthur, prince.chrismc(at)gmail(dot)com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <string_view>
+
+namespace Http
+{
+   //
+   // Access log written out by a background thread. Each thread formats its records into a buffer of its own that the
+   // writer empties in batches, so logging never waits on I/O or on another thread. Records that find their buffer
+   // full are dropped and counted, the count shows up in the log once there is room again.
+   //
+   // Lines are logfmt, "ts=... thread=... event=..." followed by whatever key=value pairs the caller formatted.
+   //
+   class AccessLog
+   {
+   public:
+      struct Options
+      {
+         std::string m_sPath = "-"; // the standard output
+         unsigned m_uSampleEvery = 1; // keep one record out of this many on each thread
+         std::chrono::milliseconds m_FlushInterval{ 100 };
+      };
+
+      // Starts the writer, throws when the file can't be opened
+      static void Open( const Options& options );
+
+      // Everything written before this returns is in the file
+      static void Close();
+
+      static bool IsOpen();
+
+      // The event must be a string literal, the format is printf style. Does nothing while the log is closed.
+      static void Write( const char* event, const char* format, ... );
+
+      // Makes a value safe inside a quoted field, '"' and '\' get a backslash and control characters become \xHH.
+      // Cut short to fit the buffer, which comes back NUL terminated for a "%s".
+      static const char* Escape( std::string_view value, char* buffer, size_t size );
+
+      static constexpr size_t RECORDS_PER_THREAD = 64;
+      static constexpr size_t RECORD_SIZE = 192; // longer records are cut short
+   };
+}
@@ -0,0 +1,50 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Chris McArthur, prince.chrismc(at)gmail(dot)com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "Arena.h"
+
+static thread_local std::pmr::memory_resource* s_pCurrentResource = nullptr;
+
+Http::Arena::Arena( size_t initial_size )
+   : m_pBuffer( new std::byte[ initial_size ] ), // left uninitialized, the arena only hands out memory it has not used yet
+   m_oResource( m_pBuffer.get(), initial_size, std::pmr::new_delete_resource() )
+{
+}
+
+Http::ArenaScope::ArenaScope( Arena& arena ) : m_pPrevious( s_pCurrentResource )
+{
+   s_pCurrentResource = arena.Resource();
+}
+
+Http::ArenaScope::~ArenaScope()
+{
+   s_pCurrentResource = m_pPrevious;
+}
+
+std::pmr::memory_resource* Http::CurrentResource()
+{
+   return s_pCurrentResource != nullptr ? s_pCurrentResource : std::pmr::new_delete_resource();
+}
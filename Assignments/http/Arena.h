@@ -0,0 +1,82 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Chris McArthur, prince.chrismc(at)gmail(dot)com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <string>
+
+namespace Http
+{
+   // Strings belonging to a request or response, drawn from whichever arena is in scope when they are created
+   using String = std::pmr::string;
+
+   //
+   // Monotonic memory for everything one request needs. Allocations only bump a pointer and nothing is freed until
+   // Reset, which hands the whole arena back at once. Meant to be owned by a single connection, it is not thread safe
+   // and takes no locks.
+   //
+   class Arena
+   {
+   public:
+      explicit Arena( size_t initial_size = DEFAULT_SIZE );
+
+      Arena( const Arena& ) = delete;
+      Arena& operator=( const Arena& ) = delete;
+
+      std::pmr::memory_resource* Resource() { return &m_oResource; }
+
+      // Every object allocated from the arena must already be gone
+      void Reset() { m_oResource.release(); }
+
+      static constexpr size_t DEFAULT_SIZE = 64 * 1024; // a browser request and a small page fit without growing
+
+   private:
+      std::unique_ptr<std::byte[]> m_pBuffer;
+      std::pmr::monotonic_buffer_resource m_oResource;
+   };
+
+   //
+   // Makes the arena the one used by HTTP objects created on this thread until the scope ends
+   //
+   class ArenaScope
+   {
+   public:
+      explicit ArenaScope( Arena& arena );
+      ~ArenaScope();
+
+      ArenaScope( const ArenaScope& ) = delete;
+      ArenaScope& operator=( const ArenaScope& ) = delete;
+
+   private:
+      std::pmr::memory_resource* m_pPrevious;
+   };
+
+   // The arena in scope on this thread, otherwise the regular heap
+   std::pmr::memory_resource* CurrentResource();
+}
@@ -0,0 +1,251 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Chris McArthur, prince.chrismc(at)gmail(dot)com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "ContentCoding.h"
+#include <stdexcept>
+
+#ifdef HTTP_WITH_ZLIB
+#include <zlib.h>
+#endif
+
+using Http::ContentCoding::Coding;
+
+static bool equalsIgnoreCase( std::string_view text, std::string_view lower )
+{
+   if( text.size() != lower.size() ) return false;
+
+   for( size_t ulIndex = 0; ulIndex < text.size(); ulIndex += 1 )
+      if( static_cast<char>( text[ ulIndex ] | 0x20 ) != lower[ ulIndex ] ) return false;
+
+   return true;
+}
+
+static std::string_view trim( std::string_view text )
+{
+   const size_t ulStart = text.find_first_not_of( " \t" );
+   if( ulStart == std::string_view::npos ) return {};
+
+   return text.substr( ulStart, text.find_last_not_of( " \t" ) - ulStart + 1 );
+}
+
+// Takes the first item of a list off the front of it
+static std::string_view nextItem( std::string_view& list, char separator )
+{
+   const size_t ulEnd = list.find( separator );
+   const std::string_view sItem = list.substr( 0, ulEnd );
+   list.remove_prefix( ulEnd == std::string_view::npos ? list.size() : ulEnd + 1 );
+   return sItem;
+}
+
+// The weight after ";q=", 1 when there is none and 0 when it makes no sense
+static double qualityOf( std::string_view parameters )
+{
+   while( !parameters.empty() )
+   {
+      const std::string_view sParameter = trim( nextItem( parameters, ';' ) );
+      if( sParameter.size() < 2 || ( sParameter[ 0 ] | 0x20 ) != 'q' || sParameter[ 1 ] != '=' ) continue;
+
+      try
+      {
+         return std::stod( std::string( sParameter.substr( 2 ) ) );
+      }
+      catch( const std::logic_error& )
+      {
+         return 0;
+      }
+   }
+
+   return 1;
+}
+
+const char* Http::ContentCoding::ToString( Coding coding )
+{
+   switch( coding )
+   {
+   case Coding::Gzip: return "gzip";
+   case Coding::Deflate: return "deflate";
+   default: return "identity";
+   }
+}
+
+std::optional<Coding> Http::ContentCoding::Parse( std::string_view name )
+{
+   name = trim( name );
+   if( name.empty() || equalsIgnoreCase( name, "identity" ) ) return Coding::Identity;
+   if( equalsIgnoreCase( name, "gzip" ) || equalsIgnoreCase( name, "x-gzip" ) ) return Coding::Gzip;
+   if( equalsIgnoreCase( name, "deflate" ) ) return Coding::Deflate;
+
+   return std::nullopt;
+}
+
+Coding Http::ContentCoding::Negotiate( std::string_view accept_encoding )
+{
+   if( !IS_AVAILABLE ) return Coding::Identity;
+
+   double dGzip = -1, dDeflate = -1, dAnything = -1; // -1 is not mentioned
+   while( !accept_encoding.empty() )
+   {
+      const std::string_view sEntry = nextItem( accept_encoding, ',' );
+      const size_t ulParameters = sEntry.find( ';' );
+      const std::string_view sName = trim( sEntry.substr( 0, ulParameters ) );
+      const double dQuality = ( ulParameters == std::string_view::npos ) ? 1 : qualityOf( sEntry.substr( ulParameters + 1 ) );
+
+      if( sName == "*" )
+         dAnything = dQuality;
+      else if( const auto oCoding = Parse( sName ); oCoding == Coding::Gzip )
+         dGzip = dQuality;
+      else if( oCoding == Coding::Deflate )
+         dDeflate = dQuality;
+   }
+
+   if( dGzip < 0 ) dGzip = dAnything;
+   if( dDeflate < 0 ) dDeflate = dAnything;
+
+   if( dGzip > 0 && dGzip >= dDeflate ) return Coding::Gzip; // smaller headers win a tie
+   if( dDeflate > 0 ) return Coding::Deflate;
+
+   return Coding::Identity;
+}
+
+std::string_view Http::ContentCoding::AcceptEncoding()
+{
+   return IS_AVAILABLE ? "gzip, deflate" : "";
+}
+
+#ifdef HTTP_WITH_ZLIB
+
+static constexpr int GZIP_WINDOW_BITS = MAX_WBITS + 16;
+static constexpr int DETECT_WINDOW_BITS = MAX_WBITS + 32; // gzip or zlib, told apart by their header
+
+std::string Http::ContentCoding::Compress( std::string_view data, Coding coding )
+{
+   if( coding == Coding::Identity ) return std::string( data );
+
+   z_stream oStream{};
+   if( deflateInit2( &oStream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, coding == Coding::Gzip ? GZIP_WINDOW_BITS : MAX_WBITS, 8, Z_DEFAULT_STRATEGY ) != Z_OK )
+      throw std::runtime_error( "Unable to start compressing" );
+
+   // The bound holds the whole result, one call does it all
+   std::string sCompressed( deflateBound( &oStream, static_cast<uLong>( data.size() ) ) + ( coding == Coding::Gzip ? 18 : 0 ), '\0' );
+   oStream.next_in = reinterpret_cast<Bytef*>( const_cast<char*>( data.data() ) );
+   oStream.avail_in = static_cast<uInt>( data.size() );
+   oStream.next_out = reinterpret_cast<Bytef*>( sCompressed.data() );
+   oStream.avail_out = static_cast<uInt>( sCompressed.size() );
+
+   const int iResult = deflate( &oStream, Z_FINISH );
+   sCompressed.resize( oStream.total_out );
+   deflateEnd( &oStream );
+
+   if( iResult != Z_STREAM_END ) throw std::runtime_error( "Unable to compress" );
+
+   return sCompressed;
+}
+
+struct Http::ContentCoding::Decoder::Stream
+{
+   z_stream m_oZlib{};
+   bool m_bEnded = false;
+};
+
+Http::ContentCoding::Decoder::Decoder( Coding coding, Sink sink ) : m_Sink( std::move( sink ) )
+{
+   if( coding == Coding::Identity ) return;
+
+   m_pStream = std::make_unique<Stream>();
+   if( inflateInit2( &m_pStream->m_oZlib, DETECT_WINDOW_BITS ) != Z_OK ) throw std::invalid_argument( "Unable to start decompressing" );
+}
+
+Http::ContentCoding::Decoder::~Decoder()
+{
+   if( m_pStream != nullptr ) inflateEnd( &m_pStream->m_oZlib );
+}
+
+bool Http::ContentCoding::Decoder::IsComplete() const
+{
+   return m_pStream == nullptr || m_pStream->m_bEnded;
+}
+
+void Http::ContentCoding::Decoder::Feed( std::string_view data )
+{
+   if( m_pStream == nullptr ) return m_Sink( data );
+   if( m_pStream->m_bEnded || data.empty() ) return;
+
+   z_stream& oZlib = m_pStream->m_oZlib;
+   oZlib.next_in = reinterpret_cast<Bytef*>( const_cast<char*>( data.data() ) );
+   oZlib.avail_in = static_cast<uInt>( data.size() );
+
+   char szBuffer[ 16 * 1024 ];
+   do
+   {
+      oZlib.next_out = reinterpret_cast<Bytef*>( szBuffer );
+      oZlib.avail_out = sizeof( szBuffer );
+
+      const int iResult = inflate( &oZlib, Z_NO_FLUSH );
+      if( iResult != Z_OK && iResult != Z_STREAM_END && iResult != Z_BUF_ERROR ) throw std::runtime_error( "Corrupt compressed body" );
+
+      const size_t ulProduced = sizeof( szBuffer ) - oZlib.avail_out;
+      if( ulProduced > 0 ) m_Sink( std::string_view( szBuffer, ulProduced ) );
+
+      if( iResult == Z_STREAM_END )
+      {
+         m_pStream->m_bEnded = true;
+         break;
+      }
+      if( iResult == Z_BUF_ERROR ) break; // nothing more without more input
+   } while( oZlib.avail_in > 0 || oZlib.avail_out == 0 );
+}
+
+#else
+
+std::string Http::ContentCoding::Compress( std::string_view data, Coding coding )
+{
+   if( coding == Coding::Identity ) return std::string( data );
+
+   throw std::runtime_error( "Built without zlib, only identity is available" );
+}
+
+struct Http::ContentCoding::Decoder::Stream
+{
+};
+
+Http::ContentCoding::Decoder::Decoder( Coding coding, Sink sink ) : m_Sink( std::move( sink ) )
+{
+   if( coding != Coding::Identity ) throw std::invalid_argument( "Built without zlib, only identity is available" );
+}
+
+Http::ContentCoding::Decoder::~Decoder() = default;
+
+bool Http::ContentCoding::Decoder::IsComplete() const
+{
+   return true;
+}
+
+void Http::ContentCoding::Decoder::Feed( std::string_view data )
+{
+   m_Sink( data );
+}
+
+#endif
@@ -0,0 +1,91 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Chris McArthur, prince.chrismc(at)gmail(dot)com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+//
+// The gzip and deflate content codings ( RFC 9110 ), built on zlib when CMake found it and defined HTTP_WITH_ZLIB.
+// Without it only identity is ever negotiated and nothing else is asked for, so both ends keep working uncompressed.
+//
+namespace Http::ContentCoding
+{
+   enum class Coding
+   {
+      Identity,
+      Gzip,
+      Deflate // the zlib format, as RFC 9110 defines it, not a raw deflate stream
+   };
+
+#ifdef HTTP_WITH_ZLIB
+   constexpr bool IS_AVAILABLE = true;
+#else
+   constexpr bool IS_AVAILABLE = false;
+#endif
+
+   const char* ToString( Coding coding );
+
+   // The coding a Content-Encoding names, nothing for one that is not supported here
+   std::optional<Coding> Parse( std::string_view name );
+
+   // The best coding the Accept-Encoding of a request allows ( q-values included ), identity when it allows no other
+   Coding Negotiate( std::string_view accept_encoding );
+
+   // What a request should accept, empty when nothing but identity can be decoded
+   std::string_view AcceptEncoding();
+
+   // Throws std::runtime_error when zlib fails or is not available
+   std::string Compress( std::string_view data, Coding coding );
+
+   //
+   // Decodes a body as it arrives, the decoded bytes go to the sink. Identity passes everything through.
+   //
+   class Decoder
+   {
+   public:
+      using Sink = std::function<void( std::string_view )>;
+
+      Decoder( Coding coding, Sink sink ); // throws std::invalid_argument for a coding that is not available
+      ~Decoder();
+
+      Decoder( const Decoder& ) = delete;
+      Decoder& operator=( const Decoder& ) = delete;
+
+      void Feed( std::string_view data ); // throws std::runtime_error when the data is corrupt
+      bool IsComplete() const; // whether the end of the compressed data was seen, a body cut short is not
+
+   private:
+      struct Stream; // the zlib state, kept out of this header
+
+      Sink m_Sink;
+      std::unique_ptr<Stream> m_pStream; // none for identity
+   };
+}
@@ -27,6 +27,7 @@ SOFTWARE.
 #include "HttpRequest.h"
 #include  <algorithm>
 #include <cctype>
+#include <string_view>
 
 /*  EXAMPLE REQUEST
 
@@ -65,6 +66,7 @@ Upgrade-Insecure-Requests: 1
 #define PATCH_STRING "PATCH"
 
 #define HTTP_VERSION_PREFIX " HTTP/"
+#define HTTP_VERSION_1_PREFIX "HTTP/1."
 #define HTTP_VERSION_10_STRING "HTTP/1.0"
 #define HTTP_VERSION_11_STRING "HTTP/1.1"
 
@@ -73,20 +75,19 @@ Upgrade-Insecure-Requests: 1
 #define HTTP_CONTENT_LENGTH "Content-Length"
 
 #define HTTP_HOST_RAW "Host: "
-#define HTTP_CONTENT_TYPE_RAW "Content-Type: "
 #define HTTP_CONTENT_LENGTH_RAW "Content-Length: "
 
-#define HTTP_BODY_SEPERATOR "\r\n\r\n"
 #define SIZE_OF_CRLF ( sizeof( CRLF ) - 1 )
-#define SIZE_OF_HTTP_BODY_SEPERATOR ( sizeof( HTTP_BODY_SEPERATOR ) - 1 )
+
+#define HEADER_WHITESPACE " \t"
 
 // Thanks to https://stackoverflow.com/a/1798170/8480874
-std::string trim( const std::string& str,
-                  const std::string& whitespace /*= " \t"*/ )
+std::string_view trim( std::string_view str,
+                       std::string_view whitespace /*= " \t"*/ )
 {
    const auto strBegin = str.find_first_not_of( whitespace );
-   if( strBegin == std::string::npos )
-      return ""; // no content
+   if( strBegin == std::string_view::npos )
+      return {}; // no content
 
    const auto strEnd = str.find_last_not_of( whitespace );
    const auto strRange = strEnd - strBegin + 1;
@@ -94,26 +95,50 @@ std::string trim( const std::string& str,
    return str.substr( strBegin, strRange );
 }
 
-std::string reduce( const std::string& str,
-                    const std::string& fill /*= " "*/,
-                    const std::string& whitespace /*= " \t"*/ )
+// True when reduce would give back exactly what it was given
+static bool isReduced( std::string_view str, std::string_view fill, std::string_view whitespace )
 {
-    // trim first
-   auto result = trim( str, whitespace );
+   if( str.empty() ) return true;
+   if( whitespace.find( str.front() ) != std::string_view::npos || whitespace.find( str.back() ) != std::string_view::npos ) return false;
 
-   // replace sub ranges
-   auto beginSpace = result.find_first_of( whitespace );
-   while( beginSpace != std::string::npos )
+   for( size_t ulSpace = str.find_first_of( whitespace ); ulSpace != std::string_view::npos; )
    {
-      const auto endSpace = result.find_first_not_of( whitespace, beginSpace );
-      const auto range = endSpace - beginSpace;
+      const size_t ulEnd = str.find_first_not_of( whitespace, ulSpace );
+      if( str.substr( ulSpace, ulEnd - ulSpace ) != fill ) return false;
 
-      result.replace( beginSpace, range, fill );
+      ulSpace = str.find_first_of( whitespace, ulEnd );
+   }
 
-      const auto newStart = beginSpace + fill.length();
-      beginSpace = result.find_first_of( whitespace, newStart );
+   return true;
+}
+
+// Copies an already trimmed string over, one fill for each run of whitespace
+template<typename String>
+static void appendReduced( String& out, std::string_view trimmed, std::string_view fill, std::string_view whitespace )
+{
+   size_t ulStart = 0;
+   for( size_t ulSpace = trimmed.find_first_of( whitespace ); ulSpace != std::string_view::npos;
+        ulSpace = trimmed.find_first_of( whitespace, ulStart ) )
+   {
+      out.append( trimmed.substr( ulStart, ulSpace - ulStart ) ).append( fill );
+      ulStart = trimmed.find_first_not_of( whitespace, ulSpace ); // never npos, there is no trailing whitespace
    }
 
+   out.append( trimmed.substr( ulStart ) );
+}
+
+std::string reduce( std::string_view str,
+                    std::string_view fill /*= " "*/,
+                    std::string_view whitespace /*= " \t"*/ )
+{
+   if( isReduced( str, fill, whitespace ) ) return std::string( str );
+
+   const std::string_view trimmed = trim( str, whitespace );
+
+   std::string result;
+   result.reserve( trimmed.size() + fill.size() * 4 );
+   appendReduced( result, trimmed, fill, whitespace );
+
    return result;
 }
 
@@ -122,19 +147,24 @@ std::string reduce( const std::string& str,
 // Http::Headers
 //
 //---------------------------------------------------------------------------------------------------------------------
-bool Http::Comparison::operator()( const std::string& lhs, const std::string& rhs ) const
+bool Http::Comparison::operator()( std::string_view lhs, std::string_view rhs ) const
 {
-   return std::lexicographical_compare(
-      lhs.begin(), lhs.end(),
-      rhs.begin(), rhs.end(),
-      []( char c1, char c2 )
-      {
-         return ::tolower( c1 ) < ::tolower( c2 );
-      } );
+   // Header names are ASCII tokens, folding the case by hand avoids a locale lookup for every character
+   const auto fold = []( unsigned char c ) { return ( c >= 'A' && c <= 'Z' ) ? static_cast<unsigned char>( c + ( 'a' - 'A' ) ) : c; };
+
+   const size_t ulLength = std::min( lhs.size(), rhs.size() );
+   for( size_t ulIndex = 0; ulIndex < ulLength; ulIndex += 1 )
+   {
+      const unsigned char c1 = fold( lhs[ ulIndex ] );
+      const unsigned char c2 = fold( rhs[ ulIndex ] );
+      if( c1 != c2 ) return c1 < c2;
+   }
+
+   return lhs.size() < rhs.size();
 }
 
-Http::Headers::Headers( std::initializer_list<value_type> headers )
-   : std::map<std::string, std::string, Comparison>( headers )
+Http::Headers::Headers( std::initializer_list<value_type> headers, std::pmr::memory_resource* resource )
+   : std::pmr::map<String, String, Comparison>( headers, Comparison(), resource )
 {
 }
 
@@ -174,36 +204,62 @@ std::string Http::Headers::AsString() const
    std::string buffer;
 
    for( ConstHeader header : *this )
-      buffer += ( header.key + ": " + header.value + CRLF );
+      buffer.append( header.key ).append( ": " ).append( header.value ).append( CRLF );
 
    return buffer;
 }
 
-std::string Http::Headers::FormatHeaderKey( const std::string& in_krsHeaderKey )
+static bool isSpace( char c ) { return c == ' ' || c == '\t'; }
+
+// Canonical keys are words joined by '-', each with only its first letter capitalised ( e.g. Content-Length )
+static char canonicalKeyCharacter( char previous, char c )
 {
-   if( in_krsHeaderKey.empty() )
-      return in_krsHeaderKey;
+   if( c == '-' || isSpace( c ) ) return '-';
 
-   auto key = reduce( in_krsHeaderKey, "-" );
-   std::transform( key.begin(), key.end(), key.begin(), []( char c )->char { return static_cast<char>( std::tolower( c ) ); } );
+   const bool bWordStart = ( previous == '\0' || previous == '-' || isSpace( previous ) );
+   return static_cast<char>( bWordStart ? std::toupper( static_cast<unsigned char>( c ) ) : std::tolower( static_cast<unsigned char>( c ) ) );
+}
 
-   key[ 0 ] = static_cast<char>( std::toupper( key[ 0 ] ) );
+Http::String Http::Headers::FormatHeaderKey( std::string_view in_krsHeaderKey )
+{
+   size_t ulIndex = 0;
+   for( char previous = '\0'; ulIndex < in_krsHeaderKey.size(); previous = in_krsHeaderKey[ ulIndex++ ] )
+   {
+      if( in_krsHeaderKey[ ulIndex ] != canonicalKeyCharacter( previous, in_krsHeaderKey[ ulIndex ] ) ) break;
+   }
+
+   if( ulIndex == in_krsHeaderKey.size() ) return String( in_krsHeaderKey, CurrentResource() );
+
+   const std::string_view sTrimmed = trim( in_krsHeaderKey, HEADER_WHITESPACE );
+
+   String key( CurrentResource() );
+   key.reserve( sTrimmed.size() );
 
-   auto beginSpace = key.find_first_of( '-' );
-   while( beginSpace != std::string::npos )
+   char previous = '\0';
+   for( char c : sTrimmed )
    {
-      beginSpace += 1;
-      if( beginSpace <= key.length() )
-      {
-         key[ beginSpace ] = static_cast<char>( std::toupper( key[ beginSpace ] ) );
-      }
+      if( !( isSpace( c ) && isSpace( previous ) ) ) // a run of whitespace becomes a single '-'
+         key.push_back( canonicalKeyCharacter( previous, c ) );
 
-      beginSpace = key.find_first_of( '-', beginSpace );
+      previous = c;
    }
 
    return key;
 }
 
+Http::String Http::Headers::FormatHeaderValue( std::string_view in_krsHeaderValue )
+{
+   if( isReduced( in_krsHeaderValue, " ", HEADER_WHITESPACE ) ) return String( in_krsHeaderValue, CurrentResource() );
+
+   const std::string_view sTrimmed = trim( in_krsHeaderValue, HEADER_WHITESPACE );
+
+   String value( CurrentResource() );
+   value.reserve( sTrimmed.size() );
+   appendReduced( value, sTrimmed, " ", HEADER_WHITESPACE );
+
+   return value;
+}
+
 //---------------------------------------------------------------------------------------------------------------------
 //
 // HttpRequest
@@ -227,7 +283,7 @@ HttpRequest::HttpRequest( Http::RequestMethod method, const std::string & uri,
                           Http::Version version, const std::string & host_port,
                           Http::ContentType content_type, std::initializer_list<Http::Header::Entry> headers ) :
    m_eMethod( method ),
-   m_sRequestUri( uri ),
+   m_sRequestUri( uri, Http::CurrentResource() ),
    m_eVersion( version ),
    m_eContentType( Http::ContentType::Invalid ),
    m_oHeaders( headers )
@@ -251,11 +307,11 @@ void HttpRequest::SetContentType( Http::ContentType content_type )
    m_oHeaders.SetContentType( m_eContentType );
 }
 
-void HttpRequest::SetMessageHeader( const std::string & key, const std::string & value )
+void HttpRequest::SetMessageHeader( std::string_view key, std::string_view value )
 {
    if( key.empty() || value.empty() ) return;
 
-   const Http::EmplaceResult retval = m_oHeaders.emplace( Http::Headers::FormatHeaderKey( key ), reduce( value ) );
+   const Http::EmplaceResult retval = m_oHeaders.emplace( Http::Headers::FormatHeaderKey( key ), Http::Headers::FormatHeaderValue( value ) );
 
    if( !retval.success ) // already exists
    {
@@ -263,7 +319,7 @@ void HttpRequest::SetMessageHeader( const std::string & key, const std::string &
    }
 }
 
-bool HttpRequest::HasMessageHeader( const std::string& key, const std::string& value /* = "" */)
+bool HttpRequest::HasMessageHeader( std::string_view key, std::string_view value /* = "" */ ) const
 {
    const auto itor = m_oHeaders.find( key );
    if( itor != std::end( m_oHeaders ) )
@@ -279,7 +335,15 @@ bool HttpRequest::HasMessageHeader( const std::string& key, const std::string& v
    return false;
 }
 
-void HttpRequest::AppendMessageBody( const std::string & data )
+std::string_view HttpRequest::GetMessageHeader( std::string_view key ) const
+{
+   const auto itor = m_oHeaders.find( key );
+   if( itor == std::end( m_oHeaders ) ) return {};
+
+   return itor->second;
+}
+
+void HttpRequest::AppendMessageBody( std::string_view data )
 {
    m_sBody.append( data );
    m_oHeaders.SetContentLength( m_sBody.length() );
@@ -287,7 +351,7 @@ void HttpRequest::AppendMessageBody( const std::string & data )
 
 std::string HttpRequest::GetRequestLine() const
 {
-   return STATIC_MethodAsString( m_eMethod ) + " " + m_sRequestUri + " " + STATIC_VersionAsString( m_eVersion ) + CRLF;
+   return STATIC_MethodAsString( m_eMethod ).append( " " ).append( m_sRequestUri ).append( " " ).append( STATIC_VersionAsString( m_eVersion ) ).append( CRLF );
 }
 
 std::string HttpRequest::GetHeaders() const
@@ -297,7 +361,7 @@ std::string HttpRequest::GetHeaders() const
 
 std::string HttpRequest::GetWireFormat() const
 {
-   return GetRequestLine() + GetHeaders() + CRLF + m_sBody;
+   return GetRequestLine().append( GetHeaders() ).append( CRLF ).append( m_sBody );
 }
 
 std::string HttpRequest::STATIC_MethodAsString( Http::RequestMethod method )
@@ -377,110 +441,163 @@ bool HttpRequestParser::AppendRequestData( const std::string & data )
 {
    if( data.empty() ) return true;
 
-   if( STATIC_IsHeaderComplete( m_sHttpHeader ) )
-   {
-      m_sMessageBody.append( data );
-      return( m_sMessageBody.size() == STATIC_ParseForContentLength( m_sHttpHeader ) );
-   }
+   if( m_oHeaderEnd.IsComplete() ) return AppendBodyData( data );
 
-   const size_t ullSeperatorIndex = data.find( HTTP_BODY_SEPERATOR );
-   if( ullSeperatorIndex == std::string::npos )
+   const size_t ulBodyStart = m_oHeaderEnd.Feed( data );
+   if( ulBodyStart == std::string::npos )
    {
       m_sHttpHeader.append( data );
+      return false;
    }
-   else
-   {
-      m_sHttpHeader.append( data.substr( 0, ullSeperatorIndex + SIZE_OF_HTTP_BODY_SEPERATOR ) );
-      m_sMessageBody.append( data.substr( ullSeperatorIndex + SIZE_OF_HTTP_BODY_SEPERATOR ) );
-   }
-   return STATIC_IsHeaderComplete( m_sHttpHeader ) && ( m_sMessageBody.size() == STATIC_ParseForContentLength( m_sHttpHeader ) );
+
+   m_sHttpHeader.append( data, 0, ulBodyStart );
+   m_ulContentLength = STATIC_ParseForContentLength( m_sHttpHeader );
+
+   return AppendBodyData( std::string_view( data ).substr( ulBodyStart ) );
 }
 
-Http::RequestMethod HttpRequestParser::STATIC_ParseForMethod( const std::string & request )
+bool HttpRequestParser::HasContentLength() const
 {
-   if( request.find( OPTIONS_STRING ) == 0 ) return Http::RequestMethod::Options;
-   if( request.find( GET_STRING ) == 0 ) return Http::RequestMethod::Get;
-   if( request.find( HEAD_STRING ) == 0 ) return Http::RequestMethod::Head;
-   if( request.find( POST_STRING ) == 0 ) return Http::RequestMethod::Post;
-   if( request.find( PUT_STRING ) == 0 ) return Http::RequestMethod::Put;
-   if( request.find( DELETE_STRING ) == 0 ) return Http::RequestMethod::Delete;
-   if( request.find( TRACE_STRING ) == 0 ) return Http::RequestMethod::Trace;
-   if( request.find( CONNECT_STRING ) == 0 ) return Http::RequestMethod::Connect;
-   if( request.find( PATCH_STRING ) == 0 ) return Http::RequestMethod::Patch;
+   return m_sHttpHeader.find( HTTP_CONTENT_LENGTH_RAW ) != std::string::npos;
+}
+
+bool HttpRequestParser::AppendBodyData( std::string_view data )
+{
+   // The body ends where the Content-Length says, anything after belongs to the next message
+   const size_t ulMissing = m_ulContentLength - std::min( m_ulContentLength, m_sMessageBody.size() );
+   m_sMessageBody.append( data.substr( 0, ulMissing ) );
+   if( data.size() > ulMissing ) m_sExcess.append( data.substr( ulMissing ) );
+
+   return( m_sMessageBody.size() == m_ulContentLength );
+}
+
+// Tokens are told apart by their length and one or two letters, one comparison then confirms the only candidate
+static constexpr unsigned tokenKey( size_t length, char first, char second = '\0' )
+{
+   return static_cast<unsigned>( length ) << 16 | static_cast<unsigned char>( first ) << 8 | static_cast<unsigned char>( second );
+}
+
+template<typename Enum>
+static Enum confirmToken( std::string_view token, std::string_view candidate, Enum match )
+{
+   return token == candidate ? match : Enum::Invalid;
+}
+
+Http::RequestMethod HttpRequestParser::STATIC_ParseForMethod( std::string_view request )
+{
+   // Never look further than the longest method, garbage should not cost a scan of the whole buffer
+   constexpr size_t MAX_METHOD_LENGTH = sizeof( OPTIONS_STRING ) - 1;
+   const std::string_view prefix = request.substr( 0, MAX_METHOD_LENGTH + 1 );
+   const std::string_view token = prefix.substr( 0, prefix.find( ' ' ) );
+
+   if( token.empty() || token.size() > MAX_METHOD_LENGTH ) return Http::RequestMethod::Invalid;
 
-   return Http::RequestMethod::Invalid;
+   switch( tokenKey( token.size(), token.front() ) )
+   {
+   case tokenKey( sizeof( GET_STRING ) - 1, 'G' ): return confirmToken( token, GET_STRING, Http::RequestMethod::Get );
+   case tokenKey( sizeof( PUT_STRING ) - 1, 'P' ): return confirmToken( token, PUT_STRING, Http::RequestMethod::Put );
+   case tokenKey( sizeof( HEAD_STRING ) - 1, 'H' ): return confirmToken( token, HEAD_STRING, Http::RequestMethod::Head );
+   case tokenKey( sizeof( POST_STRING ) - 1, 'P' ): return confirmToken( token, POST_STRING, Http::RequestMethod::Post );
+   case tokenKey( sizeof( TRACE_STRING ) - 1, 'T' ): return confirmToken( token, TRACE_STRING, Http::RequestMethod::Trace );
+   case tokenKey( sizeof( PATCH_STRING ) - 1, 'P' ): return confirmToken( token, PATCH_STRING, Http::RequestMethod::Patch );
+   case tokenKey( sizeof( DELETE_STRING ) - 1, 'D' ): return confirmToken( token, DELETE_STRING, Http::RequestMethod::Delete );
+   case tokenKey( sizeof( OPTIONS_STRING ) - 1, 'O' ): return confirmToken( token, OPTIONS_STRING, Http::RequestMethod::Options );
+   case tokenKey( sizeof( CONNECT_STRING ) - 1, 'C' ): return confirmToken( token, CONNECT_STRING, Http::RequestMethod::Connect );
+   default: return Http::RequestMethod::Invalid;
+   }
 }
 
-std::string HttpRequestParser::STATIC_ParseForRequestUri( const std::string & request )
+std::string HttpRequestParser::STATIC_ParseForRequestUri( std::string_view request )
 {
    if( request.empty() ) return "";
 
-   const std::string sRequestLine = request.substr( 0, request.find( HTTP_VERSION_PREFIX ) );
+   const std::string_view sRequestLine = request.substr( 0, request.find( HTTP_VERSION_PREFIX ) );
    const size_t ulOffset = HttpRequest::STATIC_MethodAsString( STATIC_ParseForMethod( sRequestLine ) ).size() + 1;
 
-   return sRequestLine.substr( ulOffset );
+   return std::string( sRequestLine.substr( ulOffset ) );
 }
 
-Http::Version HttpRequestParser::STATIC_ParseForVersion( const std::string & request )
+Http::Version HttpRequestParser::STATIC_ParseForVersion( std::string_view request )
 {
-   if( request.find( HTTP_VERSION_10_STRING ) != std::string::npos ) return Http::Version::v10;
-   if( request.find( HTTP_VERSION_11_STRING ) != std::string::npos ) return Http::Version::v11;
+   constexpr size_t VERSION_LENGTH = sizeof( HTTP_VERSION_10_STRING ) - 1;
+   constexpr size_t PREFIX_LENGTH = sizeof( HTTP_VERSION_1_PREFIX ) - 1;
+
+   // Responses lead with the version, requests end their first line with it
+   const std::string_view message = request;
+   std::string_view token = message.substr( 0, VERSION_LENGTH );
+   if( token.compare( 0, PREFIX_LENGTH, HTTP_VERSION_1_PREFIX ) != 0 )
+   {
+      const size_t ulEnd = std::min( message.find( CRLF ), message.size() );
+      const size_t ulStart = message.rfind( ' ', ulEnd );
+      if( ulStart == std::string_view::npos ) return Http::Version::Invalid;
+
+      token = message.substr( ulStart + 1, ulEnd - ulStart - 1 );
+   }
+
+   if( token.size() != VERSION_LENGTH || token.compare( 0, PREFIX_LENGTH, HTTP_VERSION_1_PREFIX ) != 0 ) return Http::Version::Invalid;
 
-   return Http::Version::Invalid;
+   switch( token.back() )
+   {
+   case HTTP_VERSION_10_STRING[ PREFIX_LENGTH ]: return Http::Version::v10;
+   case HTTP_VERSION_11_STRING[ PREFIX_LENGTH ]: return Http::Version::v11;
+   default: return Http::Version::Invalid;
+   }
 }
 
-std::string HttpRequestParser::STATIC_ParseForHostAndPort( const std::string & request )
+std::string HttpRequestParser::STATIC_ParseForHostAndPort( std::string_view request )
 {
    if( !request.empty() )
    {
       const size_t ulOffset = request.find( HTTP_HOST_RAW ) + sizeof( HTTP_HOST_RAW ) - 1;
       const size_t ulEnd = request.find( CRLF, ulOffset );
-      return request.substr( ulOffset, ulEnd - ulOffset );
+      return std::string( request.substr( ulOffset, ulEnd - ulOffset ) );
    }
 
    return "";
 }
 
-Http::ContentType HttpRequestParser::STATIC_ParseForContentType( const std::string & request )
+Http::ContentType HttpRequestParser::STATIC_ParseForContentType( std::string_view request )
 {
    if( request.empty() ) return Http::ContentType::Invalid;
 
-   if( request.find( HTTP_CONTENT_TYPE ) == std::string::npos ) return Http::ContentType::Invalid;
+   const size_t ulHeader = request.find( HTTP_CONTENT_TYPE ":" );
+   if( ulHeader == std::string::npos ) return Http::ContentType::Invalid;
 
-   const size_t ulOffset = request.find( HTTP_CONTENT_TYPE_RAW ) + sizeof( HTTP_CONTENT_TYPE_RAW ) - 1;
-   const size_t ulEnd = request.find( CRLF, ulOffset );
-   const std::string sContentTypeLine = request.substr( ulOffset, ulEnd - ulOffset );
+   // Only the media type matters, parameters such as 'charset=utf-8' follow a ';' and are skipped
+   std::string_view value = request.substr( ulHeader + sizeof( HTTP_CONTENT_TYPE ":" ) - 1 );
+   value.remove_prefix( std::min( value.find_first_not_of( " \t" ), value.size() ) );
+   const std::string_view mediaType = value.substr( 0, value.find_first_of( "; \t\r\n" ) );
 
-   const size_t ulTextPos = sContentTypeLine.find( "text" );
-   const size_t ulHtmlPos = sContentTypeLine.find( "text/html" );
-   const size_t ulJsonPos = sContentTypeLine.find( "text/json" );
-   const size_t ulHtmlAppPos = sContentTypeLine.find( "application/html" );
-   const size_t ulJsonAppPos = sContentTypeLine.find( "application/json" );
-   const size_t ulYamlPos = sContentTypeLine.find( "text/yaml" );
-   const size_t ulYamlAppPos = sContentTypeLine.find( "application/x-yaml" );
-   const size_t ulXmlPos = sContentTypeLine.find( "text/xml" );
-   const size_t ulGifPos = sContentTypeLine.find( "image/gif" );
-   const size_t ulIcoPos = sContentTypeLine.find( "image/x-icon" );
-   const size_t ulPngPos = sContentTypeLine.find( "image/png" );
+   // Media types are case insensitive, the longest one we know of easily fits in here
+   char lowered[ 32 ]{};
+   if( mediaType.size() >= sizeof( lowered ) ) return Http::ContentType::Invalid;
 
-   const size_t ulMinPos = std::min( { ulTextPos, ulHtmlPos, ulJsonPos, ulHtmlAppPos, ulJsonAppPos, ulYamlPos, ulYamlAppPos, ulXmlPos, ulGifPos, ulIcoPos, ulPngPos } );
+   std::transform( mediaType.begin(), mediaType.end(), lowered, []( unsigned char c ) { return static_cast<char>( std::tolower( c ) ); } );
+   const std::string_view type( lowered, mediaType.size() );
 
-   if( ulMinPos == ulHtmlPos ) return Http::ContentType::Html;
-   if( ulMinPos == ulJsonPos ) return Http::ContentType::Json;
-   if( ulMinPos == ulHtmlAppPos ) return Http::ContentType::Html;
-   if( ulMinPos == ulJsonAppPos ) return Http::ContentType::Json;
-   if( ulMinPos == ulYamlPos ) return Http::ContentType::Yaml;
-   if( ulMinPos == ulYamlAppPos ) return Http::ContentType::Yaml;
-   if( ulMinPos == ulXmlPos ) return Http::ContentType::Xml;
-   if( ulMinPos == ulGifPos ) return Http::ContentType::Gif;
-   if( ulMinPos == ulIcoPos ) return Http::ContentType::Ico;
-   if( ulMinPos == ulPngPos ) return Http::ContentType::Png;
-   if( ulMinPos == ulTextPos ) return Http::ContentType::Text;
+   const size_t ulSlash = type.find( '/' );
+   if( ulSlash == std::string_view::npos || ulSlash + 1 == type.size() ) return Http::ContentType::Invalid;
 
-   return Http::ContentType::Invalid;
+   switch( tokenKey( type.size(), type.front(), type[ ulSlash + 1 ] ) )
+   {
+   case tokenKey( sizeof( "text/html" ) - 1, 't', 'h' ): return confirmToken( type, "text/html", Http::ContentType::Html );
+   case tokenKey( sizeof( "text/json" ) - 1, 't', 'j' ): return confirmToken( type, "text/json", Http::ContentType::Json );
+   case tokenKey( sizeof( "text/yaml" ) - 1, 't', 'y' ): return confirmToken( type, "text/yaml", Http::ContentType::Yaml );
+   case tokenKey( sizeof( "text/xml" ) - 1, 't', 'x' ): return confirmToken( type, "text/xml", Http::ContentType::Xml );
+   case tokenKey( sizeof( "image/gif" ) - 1, 'i', 'g' ): return confirmToken( type, "image/gif", Http::ContentType::Gif );
+   case tokenKey( sizeof( "image/png" ) - 1, 'i', 'p' ): return confirmToken( type, "image/png", Http::ContentType::Png );
+   case tokenKey( sizeof( "image/x-icon" ) - 1, 'i', 'x' ): return confirmToken( type, "image/x-icon", Http::ContentType::Ico );
+   case tokenKey( sizeof( "application/html" ) - 1, 'a', 'h' ): return confirmToken( type, "application/html", Http::ContentType::Html );
+   case tokenKey( sizeof( "application/json" ) - 1, 'a', 'j' ): return confirmToken( type, "application/json", Http::ContentType::Json );
+   case tokenKey( sizeof( "application/x-yaml" ) - 1, 'a', 'x' ): return confirmToken( type, "application/x-yaml", Http::ContentType::Yaml );
+   default: break;
+   }
+
+   // Any other flavour of text is still readable as text
+   return type.compare( 0, sizeof( "text/" ) - 1, "text/" ) == 0 ? Http::ContentType::Text : Http::ContentType::Invalid;
 }
 
-size_t HttpRequestParser::STATIC_ParseForContentLength( const std::string & headers_buffer )
+size_t HttpRequestParser::STATIC_ParseForContentLength( std::string_view headers_buffer )
 {
    if( headers_buffer.empty() )
       return 0;
@@ -493,20 +610,10 @@ size_t HttpRequestParser::STATIC_ParseForContentLength( const std::string & head
    sizeStart += sizeof( HTTP_CONTENT_LENGTH_RAW ) - 1;
    const size_t sizeEnd = headers_buffer.find( CRLF, sizeStart );
 
-   std::string sContentLength = headers_buffer.substr( sizeStart, sizeEnd - sizeStart );
+   const std::string_view sContentLength = headers_buffer.substr( sizeStart, sizeEnd - sizeStart );
 
    if( sContentLength.length() && sContentLength.find_first_not_of( "0123456789" ) == std::string::npos )
-      return std::stoull( sContentLength );
+      return std::stoull( std::string( sContentLength ) );
 
    return 0;
 }
-
-bool HttpRequestParser::STATIC_IsHeaderComplete( const std::string & headers_buffer )
-{
-   if( headers_buffer.size() > SIZE_OF_HTTP_BODY_SEPERATOR )
-   {
-      return ( headers_buffer.substr( headers_buffer.size() - SIZE_OF_HTTP_BODY_SEPERATOR ) == HTTP_BODY_SEPERATOR );
-   }
-
-   return false;
-}
@@ -26,29 +26,36 @@ SOFTWARE.
 
 #pragma once
 
+#include "Arena.h"
 #include "Constants.h"
+#include "HttpScanner.h"
 #include <string>
+#include <string_view>
 #include <map>
 
-std::string trim( const std::string& str, const std::string& whitespace = " \t" );
-std::string reduce( const std::string& str, const std::string& fill = " ", const std::string& whitespace = " \t" );
+std::string_view trim( std::string_view str, std::string_view whitespace = " \t" );
+std::string reduce( std::string_view str, std::string_view fill = " ", std::string_view whitespace = " \t" );
 
 namespace Http
 {
    struct Comparison
    {
-      bool operator()( const std::string& lhs, const std::string& rhs ) const;
+      using is_transparent = void; // lookups by std::string or literals don't need to build a key
+
+      bool operator()( std::string_view lhs, std::string_view rhs ) const;
    };
 
-   struct Headers : std::map<std::string, std::string, Comparison>
+   struct Headers : std::pmr::map<String, String, Comparison>
    {
-      Headers( std::initializer_list<value_type> headers );
+      Headers( std::initializer_list<value_type> headers, std::pmr::memory_resource* resource = CurrentResource() );
       void SetContentType( ContentType in_eContentType );
       void SetContentLength( size_t length );
 
       std::string AsString() const;
 
-      static std::string FormatHeaderKey( const std::string& in_krsHeaderKey );
+      // Both hand back their input as is when it is already in canonical form
+      static String FormatHeaderKey( std::string_view in_krsHeaderKey );
+      static String FormatHeaderValue( std::string_view in_krsHeaderValue );
    };
 
    struct Header
@@ -127,15 +134,16 @@ public:
    bool IsValid() const;
 
    void SetContentType( Http::ContentType content_type );
-   void SetMessageHeader( const std::string& key, const std::string& value );
-   bool HasMessageHeader( const std::string& key, const std::string& value = "" );
-   void AppendMessageBody( const std::string& data );
+   void SetMessageHeader( std::string_view key, std::string_view value );
+   bool HasMessageHeader( std::string_view key, std::string_view value = "" ) const;
+   std::string_view GetMessageHeader( std::string_view key ) const; // empty when it was not given
+   void AppendMessageBody( std::string_view data );
 
    const Http::RequestMethod& GetMethod() const { return m_eMethod; }
-   const std::string&         GetUri() const { return m_sRequestUri; }
+   const Http::String&        GetUri() const { return m_sRequestUri; }
    const Http::Version&       GetVersion() const { return m_eVersion; }
    const Http::ContentType&   GetContentType() const { return m_eContentType; }
-   const std::string&         GetBody() const { return m_sBody; }
+   const Http::String&        GetBody() const { return m_sBody; }
 
    std::string GetRequestLine() const;
    std::string GetHeaders() const;
@@ -148,13 +156,13 @@ public:
 
 private:
    Http::RequestMethod m_eMethod;
-   std::string m_sRequestUri;
+   Http::String m_sRequestUri;
    Http::Version m_eVersion;
 
    // Optional
    Http::ContentType m_eContentType;
    Http::Headers m_oHeaders;
-   std::string m_sBody;
+   Http::String m_sBody{ Http::CurrentResource() };
 
 };
 
@@ -167,32 +175,42 @@ public:
 
    HttpRequest GetHttpRequest() const;
 
+   // Whatever arrived past the end of the message, the start of the next one when requests are pipelined
+   const Http::String& GetExcessData() const { return m_sExcess; }
+
+   size_t GetContentLength() const { return m_ulContentLength; } // known once the headers are complete
+   bool HasContentLength() const; // whether the message gave one at all
+   std::string_view GetHeaderData() const { return m_sHttpHeader; } // the start line and headers as they were received
+
 protected:
-   static Http::RequestMethod STATIC_ParseForMethod( const std::string& request );
-   static std::string STATIC_ParseForRequestUri( const std::string& request );
-   static Http::Version STATIC_ParseForVersion( const std::string& request );
-   static std::string STATIC_ParseForHostAndPort( const std::string& request );
-   static Http::ContentType STATIC_ParseForContentType( const std::string& request );
+   static Http::RequestMethod STATIC_ParseForMethod( std::string_view request );
+   static std::string STATIC_ParseForRequestUri( std::string_view request );
+   static Http::Version STATIC_ParseForVersion( std::string_view request );
+   static std::string STATIC_ParseForHostAndPort( std::string_view request );
+   static Http::ContentType STATIC_ParseForContentType( std::string_view request );
 
    template<class HTTP_MESSAGE>
-   static void STATIC_AppenedParsedHeaders( HTTP_MESSAGE& io_roRequest, const std::string & request )
+   static void STATIC_AppenedParsedHeaders( HTTP_MESSAGE& io_roRequest, std::string_view sRawHeaders )
    {
-      static constexpr auto CRLF = "\r\n";
-      for( std::string sRawHeaders = request;
-           sRawHeaders.find( CRLF ) != std::string::npos;
-           sRawHeaders = sRawHeaders.substr( sRawHeaders.find( CRLF ) + 2 ) )
+      // The request or status line comes first, it is not a header even when it holds a ':'
+      size_t ulStart = Http::Scanner::FindCrlf( sRawHeaders );
+      for( size_t ulEnd; ulStart != std::string::npos && ( ulEnd = Http::Scanner::FindCrlf( sRawHeaders, ulStart + 2 ) ) != std::string::npos; ulStart = ulEnd )
       {
-         std::string sNextHeader = sRawHeaders.substr( 0, sRawHeaders.find( CRLF ) );
-         const size_t iSeperatorIndex = sNextHeader.find( ':' );
+         const std::string_view sNextHeader = sRawHeaders.substr( ulStart + 2, ulEnd - ulStart - 2 );
+         const size_t iSeperatorIndex = Http::Scanner::FindColon( sNextHeader );
 
          if( iSeperatorIndex != std::string::npos )
             io_roRequest.SetMessageHeader( sNextHeader.substr( 0, iSeperatorIndex ), sNextHeader.substr( iSeperatorIndex + 1 ) );
       }
    }
 
-   static size_t STATIC_ParseForContentLength( const std::string& headers_buffer );
-   static bool STATIC_IsHeaderComplete( const std::string& headers_buffer );
+   static size_t STATIC_ParseForContentLength( std::string_view headers_buffer );
+
+   Http::Scanner::HeaderEndScanner m_oHeaderEnd;
+   size_t m_ulContentLength = 0; // known once the headers are complete
+   Http::String m_sHttpHeader{ Http::CurrentResource() };
+   Http::String m_sMessageBody{ Http::CurrentResource() };
+   Http::String m_sExcess{ Http::CurrentResource() };
 
-   std::string m_sHttpHeader;
-   std::string m_sMessageBody;
+   bool AppendBodyData( std::string_view data );
 };
@@ -25,6 +25,7 @@ SOFTWARE.
 */
 
 #include "HttpResponse.h"
+#include <stdexcept>
 
 /*
 
@@ -73,7 +74,7 @@ HttpResponse::HttpResponse( Http::Version version, Http::Status status, const st
                             Http::ContentType content_type, std::initializer_list<Http::Header::Entry> headers ) :
    m_eVersion( version ),
    m_eStatusCode( status ),
-   m_sReasonPhrase( reduce( reason_phrase, "", CRLF ) ),
+   m_sReasonPhrase( reduce( reason_phrase, "", CRLF ), Http::CurrentResource() ),
    m_eContentType( Http::ContentType::Invalid ),
    m_oHeaders( headers )
 {
@@ -95,11 +96,11 @@ void HttpResponse::SetContentType( Http::ContentType content_type )
    m_oHeaders.SetContentType( m_eContentType );
 }
 
-void HttpResponse::SetMessageHeader( const std::string & key, const std::string & value )
+void HttpResponse::SetMessageHeader( std::string_view key, std::string_view value )
 {
    if( key.empty() || value.empty() ) return;
 
-   const Http::EmplaceResult retval = m_oHeaders.emplace( Http::Headers::FormatHeaderKey( key ), reduce( value ) );
+   const Http::EmplaceResult retval = m_oHeaders.emplace( Http::Headers::FormatHeaderKey( key ), Http::Headers::FormatHeaderValue( value ) );
 
    if( !retval.success ) // already exists
    {
@@ -107,7 +108,7 @@ void HttpResponse::SetMessageHeader( const std::string & key, const std::string
    }
 }
 
-bool HttpResponse::HasMessageHeader( const std::string& key, const std::string& value /* = "" */ )
+bool HttpResponse::HasMessageHeader( std::string_view key, std::string_view value /* = "" */ ) const
 {
    const auto itor = m_oHeaders.find( key );
    if( itor != std::end( m_oHeaders ) )
@@ -123,7 +124,15 @@ bool HttpResponse::HasMessageHeader( const std::string& key, const std::string&
    return false;
 }
 
-void HttpResponse::AppendMessageBody( const std::string & data )
+std::string_view HttpResponse::GetMessageHeader( std::string_view key ) const
+{
+   const auto itor = m_oHeaders.find( key );
+   if( itor == std::end( m_oHeaders ) ) return {};
+
+   return itor->second;
+}
+
+void HttpResponse::AppendMessageBody( std::string_view data )
 {
    m_sBody.append( data );
    m_oHeaders.SetContentLength( m_sBody.length() );
@@ -131,9 +140,9 @@ void HttpResponse::AppendMessageBody( const std::string & data )
 
 std::string HttpResponse::GetStatusLine() const
 {
-   return HttpRequest::STATIC_VersionAsString( m_eVersion ) + " " +
-      std::to_string( static_cast<unsigned long long>( m_eStatusCode ) ) + " " +
-      m_sReasonPhrase + CRLF;
+   return std::string( HttpRequest::STATIC_VersionAsString( m_eVersion ) ).append( " " )
+      .append( std::to_string( static_cast<unsigned long long>( m_eStatusCode ) ) ).append( " " )
+      .append( m_sReasonPhrase ).append( CRLF );
 }
 
 std::string HttpResponse::GetHeaders() const
@@ -143,7 +152,7 @@ std::string HttpResponse::GetHeaders() const
 
 std::string HttpResponse::GetWireFormat() const
 {
-   return GetStatusLine() + GetHeaders() + CRLF + m_sBody;
+   return GetStatusLine().append( GetHeaders() ).append( CRLF ).append( m_sBody );
 }
 
 std::string HttpResponse::STATIC_StatusToReasonPhrase( Http::Status status )
@@ -207,19 +216,19 @@ bool HttpResponseParser::AppendResponseData( const std::string & data )
    return AppendRequestData( data );
 }
 
-Http::Status HttpResponseParser::STATIC_ParseForStatus( const std::string & request )
+Http::Status HttpResponseParser::STATIC_ParseForStatus( std::string_view request )
 {
    if( request.empty() ) return Http::Status::Invalid;
 
    const size_t ulStart = request.find( ' ' ) + sizeof( " " ) - 1;
    const size_t ulEnd = request.find( ' ', ulStart );
 
-   const long long llCode = std::stoull( request.substr( ulStart, ulEnd - ulStart ) );
+   const long long llCode = std::stoull( std::string( request.substr( ulStart, ulEnd - ulStart ) ) );
 
    return Http::Status( llCode );
 }
 
-std::string HttpResponseParser::STATIC_ParseForReasonPhrase( const std::string & request )
+std::string HttpResponseParser::STATIC_ParseForReasonPhrase( std::string_view request )
 {
    if( request.empty() ) return "";
 
@@ -228,7 +237,7 @@ std::string HttpResponseParser::STATIC_ParseForReasonPhrase( const std::string &
 
    ulOffset = request.find( ' ', ulOffset ) + 1;
    const size_t ulEnd = request.find( CRLF, ulOffset );
-   return request.substr( ulOffset, ulEnd - ulOffset );
+   return std::string( request.substr( ulOffset, ulEnd - ulOffset ) );
 }
 
 HttpResponse HttpResponseParser::GetHttpResponse() const
@@ -38,15 +38,16 @@ public:
    bool IsValid() const;
 
    void SetContentType( Http::ContentType content_type );
-   void SetMessageHeader( const std::string& key, const std::string& value );
-   bool HasMessageHeader( const std::string& key, const std::string& value = "" );
-   void AppendMessageBody( const std::string& data );
+   void SetMessageHeader( std::string_view key, std::string_view value );
+   bool HasMessageHeader( std::string_view key, std::string_view value = "" ) const;
+   std::string_view GetMessageHeader( std::string_view key ) const; // empty when it was not given
+   void AppendMessageBody( std::string_view data );
 
    const Http::Version&     GetVersion() const { return m_eVersion; }
    const Http::Status&      GetStatusCode() const { return m_eStatusCode; }
-   const std::string&       GetPhrase() const { return m_sReasonPhrase; }
+   const Http::String&      GetPhrase() const { return m_sReasonPhrase; }
    const Http::ContentType& GetContentType() const { return m_eContentType; }
-   const std::string&       GetBody() const { return m_sBody; }
+   const Http::String&      GetBody() const { return m_sBody; }
 
    std::string GetStatusLine() const;
    std::string GetHeaders() const;
@@ -57,12 +58,12 @@ public:
 private:
    Http::Version m_eVersion;
    Http::Status m_eStatusCode;
-   std::string m_sReasonPhrase;
+   Http::String m_sReasonPhrase;
 
    // Optional
    Http::ContentType m_eContentType;
    Http::Headers m_oHeaders;
-   std::string m_sBody;
+   Http::String m_sBody{ Http::CurrentResource() };
 };
 
 class HttpResponseParser : HttpRequestParser
@@ -73,7 +74,12 @@ public:
    bool AppendResponseData( const std::string& data );
    HttpResponse GetHttpResponse() const;
 
+   using HttpRequestParser::GetExcessData;
+   using HttpRequestParser::GetContentLength;
+   using HttpRequestParser::HasContentLength;
+   using HttpRequestParser::GetHeaderData;
+
 private:
-   static Http::Status STATIC_ParseForStatus( const std::string& request );
-   static std::string STATIC_ParseForReasonPhrase( const std::string& request );
+   static Http::Status STATIC_ParseForStatus( std::string_view request );
+   static std::string STATIC_ParseForReasonPhrase( std::string_view request );
 };
@@ -0,0 +1,187 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Chris McArthur, prince.chrismc(at)gmail(dot)com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "HttpResponseStream.h"
+#include <algorithm>
+#include <stdexcept>
+
+HttpResponseStream::HttpResponseStream( BodySink sink, HeadersSink onHeaders ) : m_Sink( std::move( sink ) ), m_OnHeaders( std::move( onHeaders ) )
+{
+}
+
+size_t HttpResponseStream::Feed( std::string_view data )
+{
+   if( m_bComplete ) return 0;
+
+   size_t ulUsed = 0;
+   if( !m_oHeaders.has_value() )
+   {
+      const size_t ulBodyStart = m_oHeaderEnd.Feed( data );
+      ulUsed = ( ulBodyStart == std::string_view::npos ) ? data.size() : ulBodyStart;
+      if( ulUsed > 0 ) m_oHeaderParser.AppendResponseData( std::string( data.substr( 0, ulUsed ) ) );
+
+      if( ulBodyStart == std::string_view::npos ) return ulUsed;
+
+      onHeaders();
+   }
+
+   return ulUsed + feedBody( data.substr( ulUsed ) );
+}
+
+bool HttpResponseStream::Close()
+{
+   if( m_oHeaders.has_value() && m_eFraming == Framing::UntilClose ) m_bComplete = true;
+
+   return m_bComplete;
+}
+
+bool HttpResponseStream::IsPersistent() const
+{
+   if( !m_oHeaders.has_value() || m_eFraming == Framing::UntilClose ) return false;
+
+   return m_oHeaders->GetVersion() == Http::Version::v11 && !m_oHeaders->HasMessageHeader( "Connection", "close" );
+}
+
+void HttpResponseStream::onHeaders()
+{
+   m_oHeaders = m_oHeaderParser.GetHttpResponse();
+
+   const auto eStatus = m_oHeaders->GetStatusCode();
+   const bool bNoBody = ( eStatus >= Http::Status::Continue && eStatus < Http::Status::Ok ) || eStatus == Http::Status::NoContent ||
+                        eStatus == Http::Status::NotModified;
+
+   if( !bNoBody && m_oHeaders->HasMessageHeader( "Transfer-Encoding", "chunked" ) ) // wins over any Content-Length
+   {
+      m_eFraming = Framing::Chunked;
+   }
+   else if( bNoBody || m_oHeaderParser.HasContentLength() ) // the parsed headers always hold one, of the body they were given
+   {
+      m_eFraming = Framing::ContentLength;
+      m_ulRemaining = bNoBody ? 0 : m_oHeaderParser.GetContentLength();
+      m_bComplete = m_ulRemaining == 0;
+   }
+   else
+   {
+      m_eFraming = Framing::UntilClose;
+   }
+
+   if( m_OnHeaders ) m_OnHeaders( *this );
+}
+
+size_t HttpResponseStream::feedBody( std::string_view data )
+{
+   if( m_bComplete || data.empty() ) return 0;
+   if( m_eFraming == Framing::Chunked ) return feedChunks( data );
+
+   const size_t ulTaken = ( m_eFraming == Framing::ContentLength ) ? static_cast<size_t>( std::min<uint64_t>( data.size(), m_ulRemaining ) ) : data.size();
+   if( ulTaken > 0 ) m_Sink( data.substr( 0, ulTaken ) );
+
+   m_ulBodyLength += ulTaken;
+   if( m_eFraming == Framing::ContentLength )
+   {
+      m_ulRemaining -= ulTaken;
+      m_bComplete = m_ulRemaining == 0;
+   }
+
+   return ulTaken;
+}
+
+size_t HttpResponseStream::feedChunks( std::string_view data )
+{
+   size_t ulUsed = 0;
+   while( ulUsed < data.size() && !m_bComplete )
+   {
+      if( m_eChunkPart == ChunkPart::Data )
+      {
+         const size_t ulTaken = static_cast<size_t>( std::min<uint64_t>( data.size() - ulUsed, m_ulRemaining ) );
+         m_Sink( data.substr( ulUsed, ulTaken ) );
+
+         ulUsed += ulTaken;
+         m_ulBodyLength += ulTaken;
+         m_ulRemaining -= ulTaken;
+         if( m_ulRemaining == 0 ) m_eChunkPart = ChunkPart::DataEnd;
+         continue;
+      }
+
+      // Everything else is a line, only held on to when it is split across reads
+      const size_t ulEndOfLine = data.find( '\n', ulUsed );
+      const size_t ulLineEnd = ( ulEndOfLine == std::string_view::npos ) ? data.size() : ulEndOfLine + 1;
+      const std::string_view sPiece = data.substr( ulUsed, ulLineEnd - ulUsed );
+      ulUsed = ulLineEnd;
+
+      if( ulEndOfLine == std::string_view::npos || !m_sChunkLine.empty() )
+      {
+         m_sChunkLine.append( sPiece );
+         if( m_sChunkLine.size() > MAX_CHUNK_LINE ) throw std::runtime_error( "Chunk line is too long" );
+         if( ulEndOfLine == std::string_view::npos ) break;
+
+         const std::string sLine = std::move( m_sChunkLine );
+         m_sChunkLine.clear();
+         onChunkLine( sLine );
+      }
+      else
+      {
+         onChunkLine( sPiece );
+      }
+   }
+
+   return ulUsed;
+}
+
+void HttpResponseStream::onChunkLine( std::string_view line )
+{
+   while( !line.empty() && ( line.back() == '\n' || line.back() == '\r' ) ) line.remove_suffix( 1 );
+
+   switch( m_eChunkPart )
+   {
+   case ChunkPart::Size:
+   {
+      const std::string sSize( line.substr( 0, line.find( ';' ) ) );
+      size_t ulDigits = 0;
+      try
+      {
+         m_ulRemaining = std::stoull( sSize, &ulDigits, 16 );
+      }
+      catch( const std::logic_error& )
+      {
+         throw std::runtime_error( "Malformed chunk size" );
+      }
+      if( sSize.find_first_not_of( " \t", ulDigits ) != std::string::npos ) throw std::runtime_error( "Malformed chunk size" );
+
+      m_eChunkPart = ( m_ulRemaining == 0 ) ? ChunkPart::Trailer : ChunkPart::Data;
+      break;
+   }
+   case ChunkPart::DataEnd:
+      if( !line.empty() ) throw std::runtime_error( "Chunk is longer than its size" );
+      m_eChunkPart = ChunkPart::Size;
+      break;
+   case ChunkPart::Trailer:
+      m_bComplete = line.empty(); // trailer fields are not kept
+      break;
+   default:
+      break;
+   }
+}
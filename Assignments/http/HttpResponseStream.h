@@ -0,0 +1,99 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Chris McArthur, prince.chrismc(at)gmail(dot)com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#pragma once
+
+#include "HttpResponse.h"
+#include "HttpScanner.h"
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+
+//
+// Reads a response as its bytes arrive without holding on to the body. The headers are parsed as soon as they are
+// complete, from then on every byte of the body goes straight to the sink so memory use does not grow with its size.
+//
+// The body ends after its Content-Length, after the last chunk when it is sent chunked, or when the connection closes if
+// the server gave neither. Chunks are decoded, the sink only ever sees the body itself.
+//
+class HttpResponseStream
+{
+public:
+   using BodySink = std::function<void( std::string_view )>;
+   using HeadersSink = std::function<void( const HttpResponseStream& )>; // called once, before any of the body
+
+   explicit HttpResponseStream( BodySink sink, HeadersSink onHeaders = {} );
+
+   // Returns how many bytes belong to this response, fewer than given once it is complete means the rest starts the next
+   size_t Feed( std::string_view data );
+
+   // The connection was closed, true when that completes the response rather than cutting it short
+   bool Close();
+
+   bool HasHeaders() const { return m_oHeaders.has_value(); }
+   bool IsComplete() const { return m_bComplete; }
+   bool IsPersistent() const; // the server will take another request on the same connection
+
+   const HttpResponse& GetHeaders() const { return *m_oHeaders; } // the status line and headers, without a body
+   std::string_view GetRawHeaders() const { return m_oHeaderParser.GetHeaderData(); } // exactly as the server sent them
+   uint64_t GetBodyLength() const { return m_ulBodyLength; }
+
+private:
+   enum class Framing
+   {
+      ContentLength,
+      Chunked,
+      UntilClose
+   };
+
+   enum class ChunkPart
+   {
+      Size,    // the hex length line, with any extensions
+      Data,
+      DataEnd, // the CRLF closing the data
+      Trailer  // header lines after the last chunk, up to an empty one
+   };
+
+   static constexpr size_t MAX_CHUNK_LINE = 4096;
+
+   BodySink m_Sink;
+   HeadersSink m_OnHeaders;
+   HttpResponseParser m_oHeaderParser; // never sees the body
+   Http::Scanner::HeaderEndScanner m_oHeaderEnd;
+   std::optional<HttpResponse> m_oHeaders;
+   Framing m_eFraming = Framing::ContentLength;
+   ChunkPart m_eChunkPart = ChunkPart::Size;
+   std::string m_sChunkLine;   // a chunk line split across reads
+   uint64_t m_ulRemaining = 0; // of the body, or of the current chunk
+   uint64_t m_ulBodyLength = 0;
+   bool m_bComplete = false;
+
+   void onHeaders();
+   size_t feedBody( std::string_view data );
+   size_t feedChunks( std::string_view data );
+   void onChunkLine( std::string_view line );
+};
@@ -0,0 +1,158 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Chris McArthur, prince.chrismc(at)gmail(dot)com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "HttpScanner.h"
+#include <cstring>
+
+#if defined( __AVX2__ )
+#include <immintrin.h>
+#define HTTP_SCANNER_AVX2
+#endif
+
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#include <emmintrin.h>
+#define HTTP_SCANNER_SSE2
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+static unsigned lowestSetBit( unsigned mask )
+{
+#ifdef _MSC_VER
+   unsigned long index;
+   _BitScanForward( &index, mask );
+   return static_cast<unsigned>( index );
+#else
+   return static_cast<unsigned>( __builtin_ctz( mask ) );
+#endif
+}
+
+// Every byte of the pattern is compared against a load shifted by its position, the bits left set after and'ing the
+// results are where the whole pattern starts. The length is known at compile time so the comparisons unroll.
+template<size_t Length>
+static size_t findPattern( std::string_view text, size_t from, const char ( &pattern )[ Length + 1 ] )
+{
+   const char* data = text.data();
+   const size_t size = text.size();
+   size_t pos = from;
+
+#ifdef HTTP_SCANNER_AVX2
+   __m256i wanted[ Length ];
+   for( size_t i = 0; i < Length; ++i ) wanted[ i ] = _mm256_set1_epi8( pattern[ i ] );
+
+   for( ; pos + 32 + Length - 1 <= size; pos += 32 )
+   {
+      __m256i matches = _mm256_cmpeq_epi8( _mm256_loadu_si256( reinterpret_cast<const __m256i*>( data + pos ) ), wanted[ 0 ] );
+      for( size_t i = 1; i < Length; ++i )
+         matches = _mm256_and_si256( matches, _mm256_cmpeq_epi8( _mm256_loadu_si256( reinterpret_cast<const __m256i*>( data + pos + i ) ), wanted[ i ] ) );
+
+      const unsigned mask = static_cast<unsigned>( _mm256_movemask_epi8( matches ) );
+      if( mask != 0 ) return pos + lowestSetBit( mask );
+   }
+#endif
+
+#ifdef HTTP_SCANNER_SSE2
+   __m128i expected[ Length ];
+   for( size_t i = 0; i < Length; ++i ) expected[ i ] = _mm_set1_epi8( pattern[ i ] );
+
+   for( ; pos + 16 + Length - 1 <= size; pos += 16 )
+   {
+      __m128i matches = _mm_cmpeq_epi8( _mm_loadu_si128( reinterpret_cast<const __m128i*>( data + pos ) ), expected[ 0 ] );
+      for( size_t i = 1; i < Length; ++i )
+         matches = _mm_and_si128( matches, _mm_cmpeq_epi8( _mm_loadu_si128( reinterpret_cast<const __m128i*>( data + pos + i ) ), expected[ i ] ) );
+
+      const unsigned mask = static_cast<unsigned>( _mm_movemask_epi8( matches ) );
+      if( mask != 0 ) return pos + lowestSetBit( mask );
+   }
+#endif
+
+   // Whatever is left is shorter than a stride
+   for( ; pos + Length <= size; ++pos )
+   {
+      if( std::memcmp( data + pos, pattern, Length ) == 0 ) return pos;
+   }
+
+   return std::string_view::npos;
+}
+
+size_t Http::Scanner::FindCrlf( std::string_view text, size_t from )
+{
+   return findPattern<2>( text, from, "\r\n" );
+}
+
+size_t Http::Scanner::FindColon( std::string_view text, size_t from )
+{
+   return findPattern<1>( text, from, ":" );
+}
+
+size_t Http::Scanner::FindHeaderEnd( std::string_view text, size_t from )
+{
+   return findPattern<4>( text, from, "\r\n\r\n" );
+}
+
+size_t Http::Scanner::HeaderEndScanner::Feed( std::string_view chunk )
+{
+   if( m_bComplete ) return 0;
+
+   // Finish off a terminator the previous chunk started, on a mismatch only a '\r' can begin a new one
+   size_t pos = 0;
+   for( ; m_nMatched > 0 && pos < chunk.size(); ++pos )
+   {
+      if( chunk[ pos ] == HEADER_END[ m_nMatched ] )
+         ++m_nMatched;
+      else
+         m_nMatched = ( chunk[ pos ] == '\r' ) ? 1 : 0;
+
+      if( m_nMatched == HEADER_END.size() )
+      {
+         m_bComplete = true;
+         return pos + 1;
+      }
+   }
+
+   if( m_nMatched > 0 ) return std::string_view::npos; // chunk was swallowed whole
+
+   const size_t found = FindHeaderEnd( chunk, pos );
+   if( found != std::string_view::npos )
+   {
+      m_bComplete = true;
+      return found + HEADER_END.size();
+   }
+
+   // Remember the longest start of a terminator the chunk ends with
+   for( size_t partial = HEADER_END.size() - 1; partial > 0; --partial )
+   {
+      if( chunk.size() - pos >= partial && chunk.substr( chunk.size() - partial ) == HEADER_END.substr( 0, partial ) )
+      {
+         m_nMatched = partial;
+         break;
+      }
+   }
+
+   return std::string_view::npos;
+}
@@ -0,0 +1,62 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Chris McArthur, prince.chrismc(at)gmail(dot)com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#pragma once
+
+#include <string_view>
+
+//
+// Finds the bytes that frame an HTTP message, CRLF line endings, the ':' splitting a header and the empty line ending
+// the headers. Compares 32 bytes at a time with AVX2 when the compiler targets it ( -mavx2 or /arch:AVX2 ), 16 with
+// SSE2 otherwise on x86, and falls back to a byte by byte search everywhere else.
+//
+namespace Http::Scanner
+{
+   constexpr std::string_view CRLF = "\r\n";
+   constexpr std::string_view HEADER_END = "\r\n\r\n";
+
+   // Offset of the match at or after 'from', npos when there is none
+   size_t FindCrlf( std::string_view text, size_t from = 0 );
+   size_t FindColon( std::string_view text, size_t from = 0 );
+   size_t FindHeaderEnd( std::string_view text, size_t from = 0 );
+
+   //
+   // Looks for the end of the headers as they arrive, one chunk at a time. Remembers how much of the terminator the
+   // previous chunk ended with so one split across two reads is still found, and never looks at a byte twice.
+   //
+   class HeaderEndScanner
+   {
+   public:
+      // Offset within the chunk just past the terminator, npos while the headers are still incomplete
+      size_t Feed( std::string_view chunk );
+
+      bool IsComplete() const { return m_bComplete; }
+
+   private:
+      size_t m_nMatched = 0; // bytes of HEADER_END at the end of everything fed so far
+      bool m_bComplete = false;
+   };
+}
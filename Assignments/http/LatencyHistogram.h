@@ -0,0 +1,150 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Chris McArthur, prince.chrismc(at)gmail(dot)com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+//
+// Log-linear latency histogram in the style of HdrHistogram. Every power of two is split in 16 buckets of equal width,
+// so any value is known to within about 6% whatever its magnitude. Durations are kept in nanoseconds, those above
+// MAX_VALUE land in the last bucket.
+//
+// Only one thread records into a histogram, any thread may read it. Reads are added into Counts, which is also how
+// histograms from several threads are merged.
+//
+class LatencyHistogram
+{
+public:
+   static constexpr unsigned SUB_BUCKET_BITS = 5;
+   static constexpr unsigned SUB_BUCKETS = 1u << SUB_BUCKET_BITS; // values below this are exact
+   static constexpr unsigned HALF_SUB_BUCKETS = SUB_BUCKETS / 2;
+   static constexpr unsigned MAX_SHIFT = 31; // about 68 seconds
+   static constexpr uint64_t MAX_VALUE = ( uint64_t{ SUB_BUCKETS } << MAX_SHIFT ) - 1;
+   static constexpr size_t BUCKETS = MAX_SHIFT * HALF_SUB_BUCKETS + SUB_BUCKETS;
+
+   struct Counts
+   {
+      std::array<uint64_t, BUCKETS> m_Buckets{};
+      uint64_t m_nCount = 0;
+      uint64_t m_ulSum = 0; // nanoseconds
+
+      void Merge( const Counts& other )
+      {
+         for( size_t i = 0; i < BUCKETS; ++i ) m_Buckets[ i ] += other.m_Buckets[ i ];
+         m_nCount += other.m_nCount;
+         m_ulSum += other.m_ulSum;
+      }
+
+      // The highest value that falls in the same bucket as the one at the quantile, zero when nothing was recorded
+      std::chrono::nanoseconds ValueAtQuantile( double quantile ) const
+      {
+         if( m_nCount == 0 ) return std::chrono::nanoseconds::zero();
+
+         const auto nRank = std::max<uint64_t>( 1, static_cast<uint64_t>( quantile * m_nCount + 0.5 ) );
+         uint64_t nSeen = 0;
+         for( size_t i = 0; i < BUCKETS; ++i )
+         {
+            nSeen += m_Buckets[ i ];
+            if( nSeen >= nRank ) return std::chrono::nanoseconds( HighestValueIn( i ) );
+         }
+
+         return std::chrono::nanoseconds( MAX_VALUE );
+      }
+   };
+
+   void Record( std::chrono::nanoseconds duration )
+   {
+      const uint64_t ulValue = std::min<uint64_t>( std::max<int64_t>( duration.count(), 0 ), MAX_VALUE );
+
+      // Single writer, plain loads and stores are enough and keep the lock prefix off the hot path
+      increment( m_Buckets[ BucketOf( ulValue ) ], 1 );
+      increment( m_nCount, 1 );
+      increment( m_ulSum, ulValue );
+   }
+
+   void AddTo( Counts& counts ) const
+   {
+      for( size_t i = 0; i < BUCKETS; ++i ) counts.m_Buckets[ i ] += m_Buckets[ i ].load( std::memory_order_relaxed );
+      counts.m_nCount += m_nCount.load( std::memory_order_relaxed );
+      counts.m_ulSum += m_ulSum.load( std::memory_order_relaxed );
+   }
+
+   static constexpr size_t BucketOf( uint64_t value )
+   {
+      if( value < SUB_BUCKETS ) return static_cast<size_t>( value );
+
+      const unsigned uShift = bitWidth( value ) - SUB_BUCKET_BITS;
+      return uShift * HALF_SUB_BUCKETS + static_cast<size_t>( value >> uShift );
+   }
+
+   static constexpr uint64_t LowestValueIn( size_t bucket )
+   {
+      if( bucket < SUB_BUCKETS ) return bucket;
+
+      const unsigned uShift = static_cast<unsigned>( bucket / HALF_SUB_BUCKETS ) - 1;
+      return ( bucket % HALF_SUB_BUCKETS + HALF_SUB_BUCKETS ) << uShift;
+   }
+
+   static constexpr uint64_t HighestValueIn( size_t bucket )
+   {
+      return bucket + 1 < BUCKETS ? LowestValueIn( bucket + 1 ) - 1 : MAX_VALUE;
+   }
+
+private:
+   std::array<std::atomic<uint64_t>, BUCKETS> m_Buckets{};
+   std::atomic<uint64_t> m_nCount{ 0 };
+   std::atomic<uint64_t> m_ulSum{ 0 };
+
+   static void increment( std::atomic<uint64_t>& counter, uint64_t amount )
+   {
+      counter.store( counter.load( std::memory_order_relaxed ) + amount, std::memory_order_relaxed );
+   }
+
+   static constexpr unsigned bitWidth( uint64_t value )
+   {
+      unsigned uWidth = 0;
+      for( unsigned uStep = 32; uStep > 0; uStep /= 2 )
+      {
+         if( ( value >> uStep ) != 0 )
+         {
+            value >>= uStep;
+            uWidth += uStep;
+         }
+      }
+
+      return uWidth + static_cast<unsigned>( value );
+   }
+};
+
+static_assert( LatencyHistogram::BucketOf( LatencyHistogram::SUB_BUCKETS ) == LatencyHistogram::SUB_BUCKETS, "Buckets must be contiguous" );
+static_assert( LatencyHistogram::BucketOf( LatencyHistogram::MAX_VALUE ) == LatencyHistogram::BUCKETS - 1, "The largest value needs the last bucket" );
+static_assert( LatencyHistogram::LowestValueIn( LatencyHistogram::BucketOf( 1000 ) ) <= 1000 &&
+               LatencyHistogram::HighestValueIn( LatencyHistogram::BucketOf( 1000 ) ) >= 1000, "Bucket bounds must hold their values" );
@@ -0,0 +1,229 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Chris McArthur, prince.chrismc(at)gmail(dot)com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "Url.h"
+#include <array>
+
+static constexpr bool isAlpha( char c ) { return ( c >= 'a' && c <= 'z' ) || ( c >= 'A' && c <= 'Z' ); }
+static constexpr bool isDigit( char c ) { return c >= '0' && c <= '9'; }
+static constexpr bool isSchemeChar( char c ) { return isAlpha( c ) || isDigit( c ) || c == '+' || c == '-' || c == '.'; }
+
+static constexpr int hexValue( char c )
+{
+   if( isDigit( c ) ) return c - '0';
+   if( c >= 'a' && c <= 'f' ) return c - 'a' + 10;
+   if( c >= 'A' && c <= 'F' ) return c - 'A' + 10;
+   return -1;
+}
+
+// What a character means while walking a URL, looked up once per character so a single walk both finds where each
+// component ends and rejects what has to be percent-encoded
+enum CharClass : uint8_t
+{
+   FORBIDDEN = 1, // spaces and control characters
+   ENDS_AUTHORITY = 2,
+   ENDS_PATH = 4,
+   ENDS_QUERY = 8
+};
+
+static constexpr std::array<uint8_t, 256> CHAR_CLASSES = []
+{
+   std::array<uint8_t, 256> classes{};
+   for( size_t c = 0; c <= ' '; c += 1 ) classes[ c ] = FORBIDDEN;
+   classes[ 0x7f ] = FORBIDDEN;
+   classes[ '/' ] = ENDS_AUTHORITY;
+   classes[ '?' ] = ENDS_AUTHORITY | ENDS_PATH;
+   classes[ '#' ] = ENDS_AUTHORITY | ENDS_PATH | ENDS_QUERY;
+   return classes;
+}();
+
+// Offset of the first character in any of the classes at or after 'from', the size of the text when there is none
+static size_t findClass( std::string_view text, size_t from, uint8_t classes )
+{
+   while( from < text.size() && ( CHAR_CLASSES[ static_cast<unsigned char>( text[ from ] ) ] & classes ) == 0 ) from += 1;
+   return from;
+}
+
+static bool isForbiddenAt( std::string_view text, size_t offset )
+{
+   return offset < text.size() && ( CHAR_CLASSES[ static_cast<unsigned char>( text[ offset ] ) ] & FORBIDDEN ) != 0;
+}
+
+// Compares with a lowercase scheme
+static bool equalsIgnoreCase( std::string_view text, std::string_view lower )
+{
+   if( text.size() != lower.size() ) return false;
+
+   for( size_t ulIndex = 0; ulIndex < text.size(); ulIndex += 1 )
+      if( static_cast<char>( text[ ulIndex ] | 0x20 ) != lower[ ulIndex ] ) return false;
+
+   return true;
+}
+
+// Everything from the start of the path, which is where the authority or a request's origin form ends
+static bool parsePathOnward( std::string_view rest, Http::Url& url )
+{
+   const size_t ulPathEnd = findClass( rest, 0, FORBIDDEN | ENDS_PATH );
+   if( isForbiddenAt( rest, ulPathEnd ) ) return false;
+
+   url.m_sPath = rest.substr( 0, ulPathEnd );
+   if( ulPathEnd == rest.size() ) return true;
+
+   size_t ulFragment = ulPathEnd;
+   if( rest[ ulPathEnd ] == '?' )
+   {
+      ulFragment = findClass( rest, ulPathEnd + 1, FORBIDDEN | ENDS_QUERY );
+      if( isForbiddenAt( rest, ulFragment ) ) return false;
+
+      url.m_sQuery = rest.substr( ulPathEnd + 1, ulFragment - ulPathEnd - 1 );
+      if( ulFragment == rest.size() ) return true;
+   }
+
+   if( findClass( rest, ulFragment + 1, FORBIDDEN ) != rest.size() ) return false;
+
+   url.m_sFragment = rest.substr( ulFragment + 1 );
+   return true;
+}
+
+static bool parsePort( std::string_view port, uint16_t& value )
+{
+   if( port.empty() || port.size() > 5 ) return port.empty(); // "host:" is allowed, the default port applies
+
+   uint32_t ulValue = 0;
+   for( const char c : port )
+   {
+      if( !isDigit( c ) ) return false;
+      ulValue = ulValue * 10 + static_cast<uint32_t>( c - '0' );
+   }
+
+   if( ulValue > UINT16_MAX ) return false;
+
+   value = static_cast<uint16_t>( ulValue );
+   return true;
+}
+
+static bool parseAuthority( std::string_view authority, Http::Url& url )
+{
+   const size_t ulAt = authority.rfind( '@' );
+   if( ulAt != std::string_view::npos )
+   {
+      url.m_sUserInfo = authority.substr( 0, ulAt );
+      authority.remove_prefix( ulAt + 1 );
+   }
+
+   size_t ulPortSeparator = std::string_view::npos;
+   if( !authority.empty() && authority.front() == '[' )
+   {
+      const size_t ulClose = authority.find( ']' );
+      if( ulClose == std::string_view::npos ) return false;
+
+      url.m_sHost = authority.substr( 1, ulClose - 1 );
+      url.m_bIpv6 = true;
+
+      if( ulClose + 1 < authority.size() )
+      {
+         if( authority[ ulClose + 1 ] != ':' ) return false;
+         ulPortSeparator = ulClose + 1;
+      }
+   }
+   else
+   {
+      ulPortSeparator = authority.find( ':' );
+      url.m_sHost = authority.substr( 0, ulPortSeparator );
+   }
+
+   if( url.m_sHost.empty() ) return false;
+   if( ulPortSeparator != std::string_view::npos ) url.m_sPort = authority.substr( ulPortSeparator + 1 );
+
+   return parsePort( url.m_sPort, url.m_nPort );
+}
+
+std::optional<Http::Url> Http::Url::Parse( std::string_view url )
+{
+   size_t ulSchemeEnd = 0;
+   while( ulSchemeEnd < url.size() && isSchemeChar( url[ ulSchemeEnd ] ) ) ulSchemeEnd += 1;
+
+   if( ulSchemeEnd == 0 || !isAlpha( url.front() ) || url.substr( ulSchemeEnd, 3 ) != "://" ) return std::nullopt;
+
+   Url oUrl;
+   oUrl.m_sScheme = url.substr( 0, ulSchemeEnd );
+
+   const size_t ulAuthority = ulSchemeEnd + 3;
+   const size_t ulAuthorityEnd = findClass( url, ulAuthority, FORBIDDEN | ENDS_AUTHORITY );
+   if( isForbiddenAt( url, ulAuthorityEnd ) ) return std::nullopt;
+
+   if( !parseAuthority( url.substr( ulAuthority, ulAuthorityEnd - ulAuthority ), oUrl ) ) return std::nullopt;
+   if( !parsePathOnward( url.substr( ulAuthorityEnd ), oUrl ) ) return std::nullopt;
+
+   return oUrl;
+}
+
+std::optional<Http::Url> Http::Url::ParseRequestTarget( std::string_view target )
+{
+   if( target.empty() ) return std::nullopt;
+   if( target.front() != '/' ) return Parse( target );
+
+   Url oUrl;
+   if( !parsePathOnward( target, oUrl ) ) return std::nullopt;
+
+   return oUrl;
+}
+
+uint16_t Http::Url::DefaultPortOf( std::string_view scheme )
+{
+   if( equalsIgnoreCase( scheme, "http" ) ) return 80;
+   if( equalsIgnoreCase( scheme, "https" ) ) return 443;
+
+   return 0;
+}
+
+std::string_view Http::Url::GetPathAndQuery() const
+{
+   if( m_sQuery.data() == nullptr ) return m_sPath;
+
+   return std::string_view( m_sPath.data(), static_cast<size_t>( m_sQuery.data() + m_sQuery.size() - m_sPath.data() ) );
+}
+
+bool Http::PercentDecode( std::string_view text, std::string& out )
+{
+   out.reserve( out.size() + text.size() );
+
+   // Runs without a '%' are copied whole
+   for( size_t ulPercent; ( ulPercent = text.find( '%' ) ) != std::string_view::npos; text.remove_prefix( ulPercent + 3 ) )
+   {
+      out.append( text.substr( 0, ulPercent ) );
+      if( ulPercent + 2 >= text.size() ) return false;
+
+      const int iHigh = hexValue( text[ ulPercent + 1 ] );
+      const int iLow = hexValue( text[ ulPercent + 2 ] );
+      if( iHigh < 0 || iLow < 0 ) return false;
+
+      out.push_back( static_cast<char>( iHigh << 4 | iLow ) );
+   }
+
+   out.append( text );
+   return true;
+}
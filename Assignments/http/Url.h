@@ -0,0 +1,67 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Chris McArthur, prince.chrismc(at)gmail(dot)com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace Http
+{
+   //
+   // The components of a URL ( RFC 3986 ), each a view into the text it was parsed from. They are found without
+   // allocating and left as written, PercentDecode gives the bytes a component stands for when they are needed. Parsing
+   // returns nothing for a malformed URL rather than throwing, a server sees plenty of those.
+   //
+   struct Url
+   {
+      std::string_view m_sScheme;
+      std::string_view m_sUserInfo;
+      std::string_view m_sHost;     // an IPv6 literal without its brackets
+      std::string_view m_sPort;     // empty when not given
+      std::string_view m_sPath;
+      std::string_view m_sQuery;    // after the '?', data() is null when there was none
+      std::string_view m_sFragment; // after the '#'
+      uint16_t m_nPort = 0;         // 0 when not given
+      bool m_bIpv6 = false;
+
+      // An absolute URL, "scheme://[userinfo@]host[:port][/path][?query][#fragment]"
+      static std::optional<Url> Parse( std::string_view url );
+
+      // What follows the method of a request line, "/path[?query]" or an absolute URL sent to a proxy
+      static std::optional<Url> ParseRequestTarget( std::string_view target );
+
+      static uint16_t DefaultPortOf( std::string_view scheme ); // 0 for the schemes it does not know
+
+      // The path and query as they would be sent in a request line, still a view since they are contiguous
+      std::string_view GetPathAndQuery() const;
+   };
+
+   // Appends the bytes the text stands for to out, false when a '%' is not followed by two hex digits
+   bool PercentDecode( std::string_view text, std::string& out );
+}
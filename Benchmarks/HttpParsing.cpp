@@ -0,0 +1,168 @@
+/*
+
+MIT License
+
+Copyright (c) 2018 Chris McArthur, prince.chrismc(at)gmail(dot)com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#include "HttpRequest.h"
+#include "HttpResponse.h"
+#include "HttpScanner.h"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <optional>
+
+// What a browser sends on a page load, padded out to 40 headers with the cookies and client hints they carry these days
+static std::string STATIC_BrowserRequest()
+{
+   std::string sRequest = "GET /x-nmos/node/v1.0/self/?filter=all HTTP/1.1\r\n"
+                          "Host: 25.25.34.25:12345\r\n"
+                          "User-Agent: Mozilla/5.0 (X11; Ubuntu; Linux x86_64; rv:58.0) Gecko/20100101 Firefox/58.0\r\n"
+                          "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8\r\n"
+                          "Accept-Language: en-US,en;q=0.5\r\n"
+                          "Accept-Encoding: gzip, deflate, br\r\n"
+                          "Connection: keep-alive\r\n"
+                          "Upgrade-Insecure-Requests: 1\r\n"
+                          "Cache-Control: max-age=0\r\n"
+                          "Referer: http://25.25.34.25:12345/x-nmos/node/v1.0/\r\n"
+                          "Cookie: session=05197dbd-b271-4d43-8c47-0c3e0e4a9e01; theme=dark; lang=en\r\n";
+
+   for( int i = static_cast<int>( std::count( sRequest.begin(), sRequest.end(), '\n' ) ) - 1; i < 40; ++i )
+      sRequest += "Sec-Ch-Ua-Hint-" + std::to_string( i ) + ": \"Chromium\";v=\"112\", \"Not:A-Brand\";v=\"99\"\r\n";
+
+   return sRequest + "\r\n";
+}
+
+static void BM_FindHeaderEnd_StdFind( benchmark::State& state )
+{
+   const std::string sRequest = STATIC_BrowserRequest();
+   for( auto _ : state )
+      benchmark::DoNotOptimize( sRequest.find( "\r\n\r\n" ) );
+
+   state.SetBytesProcessed( state.iterations() * sRequest.size() );
+}
+BENCHMARK( BM_FindHeaderEnd_StdFind );
+
+static void BM_FindHeaderEnd_Scanner( benchmark::State& state )
+{
+   const std::string sRequest = STATIC_BrowserRequest();
+   for( auto _ : state )
+      benchmark::DoNotOptimize( Http::Scanner::FindHeaderEnd( sRequest ) );
+
+   state.SetBytesProcessed( state.iterations() * sRequest.size() );
+}
+BENCHMARK( BM_FindHeaderEnd_Scanner );
+
+static void BM_CountLines_StdFind( benchmark::State& state )
+{
+   const std::string sRequest = STATIC_BrowserRequest();
+   for( auto _ : state )
+   {
+      size_t nLines = 0;
+      for( size_t pos = sRequest.find( "\r\n" ); pos != std::string::npos; pos = sRequest.find( "\r\n", pos + 2 ) ) ++nLines;
+      benchmark::DoNotOptimize( nLines );
+   }
+
+   state.SetBytesProcessed( state.iterations() * sRequest.size() );
+}
+BENCHMARK( BM_CountLines_StdFind );
+
+static void BM_CountLines_Scanner( benchmark::State& state )
+{
+   const std::string sRequest = STATIC_BrowserRequest();
+   for( auto _ : state )
+   {
+      size_t nLines = 0;
+      for( size_t pos = Http::Scanner::FindCrlf( sRequest ); pos != std::string::npos; pos = Http::Scanner::FindCrlf( sRequest, pos + 2 ) ) ++nLines;
+      benchmark::DoNotOptimize( nLines );
+   }
+
+   state.SetBytesProcessed( state.iterations() * sRequest.size() );
+}
+BENCHMARK( BM_CountLines_Scanner );
+
+// Feeds the request the way a socket would, in chunks of the given size
+static void BM_ParseRequest( benchmark::State& state )
+{
+   const std::string sRequest = STATIC_BrowserRequest();
+   const size_t ulChunk = static_cast<size_t>( state.range( 0 ) );
+
+   for( auto _ : state )
+   {
+      HttpRequestParser oParser;
+      for( size_t pos = 0; pos < sRequest.size(); pos += ulChunk )
+         oParser.AppendRequestData( sRequest.substr( pos, ulChunk ) );
+
+      benchmark::DoNotOptimize( oParser.GetHttpRequest() );
+   }
+
+   state.SetBytesProcessed( state.iterations() * sRequest.size() );
+}
+BENCHMARK( BM_ParseRequest )->Arg( 64 )->Arg( 512 )->Arg( 2048 );
+
+// What a connection thread does per request, once on the heap and once out of its own arena
+static void BM_HandleRequest( benchmark::State& state )
+{
+   const std::string sRequest = STATIC_BrowserRequest();
+   const bool bUseArena = state.range( 0 ) != 0;
+   Http::Arena oArena;
+
+   for( auto _ : state )
+   {
+      {
+         std::optional<Http::ArenaScope> oScope;
+         if( bUseArena ) oScope.emplace( oArena );
+
+         HttpRequestParser oParser;
+         oParser.AppendRequestData( sRequest );
+         const HttpRequest oRequest = oParser.GetHttpRequest();
+
+         HttpResponse oResponse( oRequest.GetVersion(), Http::Status::Ok, "OK", Http::ContentType::Text, {} );
+         oResponse.AppendMessageBody( oRequest.GetUri() );
+         benchmark::DoNotOptimize( oResponse.GetWireFormat() );
+      }
+
+      oArena.Reset();
+   }
+
+   state.SetBytesProcessed( state.iterations() * sRequest.size() );
+}
+BENCHMARK( BM_HandleRequest )->ArgName( "arena" )->Arg( 0 )->Arg( 1 )->ThreadRange( 1, 8 )->UseRealTime();
+
+static void BM_ParseResponse( benchmark::State& state )
+{
+   HttpResponse oResponse( Http::Version::v11, Http::Status::Ok, "OK", Http::ContentType::Html, {} );
+   oResponse.AppendMessageBody( std::string( 4096, 'x' ) );
+   const std::string sResponse = oResponse.GetWireFormat();
+
+   for( auto _ : state )
+   {
+      HttpResponseParser oParser;
+      oParser.AppendResponseData( sResponse );
+      benchmark::DoNotOptimize( oParser.GetHttpResponse() );
+   }
+
+   state.SetBytesProcessed( state.iterations() * sResponse.size() );
+}
+BENCHMARK( BM_ParseResponse );
+
+BENCHMARK_MAIN();